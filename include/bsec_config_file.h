@@ -0,0 +1,32 @@
+#pragma once
+// BSEC 配置容器格式: src/bsec_config.cpp 读取。文件 (LittleFS/SD 上的 <名称>.bcfg) 与 flash 分区槽位使用同一布局,
+// 安装时原样拷贝。小端; blob 即 BSEC/AI-Studio 导出的二进制配置, CRC-32 与 zlib.crc32() 相同。
+// 由 AI-Studio 导出的配置生成容器:
+//   python3 -c "import sys,zlib,struct;b=open(sys.argv[1],'rb').read();open(sys.argv[2],'wb').write(struct.pack('<III20s',0x31464342,len(b),zlib.crc32(b),sys.argv[3].encode()[:19])+b)" bsec_config.bin model.bcfg model
+#include <stddef.h>
+#include <stdint.h>
+
+namespace bsecCfg {
+
+static const uint32_t kMagic = 0x31464342; // "BCF1"
+static const size_t kNameLen = 20;         // 含结尾 '\0'
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t size;           // blob 字节数
+  uint32_t crc32;          // blob 的 CRC-32
+  char name[kNameLen];
+};
+
+static_assert(sizeof(FileHeader) == 32, "FileHeader layout");
+
+inline uint32_t crc32(const uint8_t *data, size_t len, uint32_t crc = 0) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+} // namespace bsecCfg
@@ -0,0 +1,43 @@
+#pragma once
+// 原始测量录制文件格式: src/recorder.cpp 写入, lib/HostHal 回放读取。
+// 小端、定长记录; 时间戳按相对上一条记录的微秒差存储, 每条 24 字节。
+#include <stdint.h>
+
+namespace rawrec {
+
+static const uint32_t kMagic = 0x52454D42; // "BMER"
+static const uint16_t kVersion = 1;
+
+struct FileHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;
+  int64_t t0Ns;            // 第一条记录的 dtUs 相对于此时间戳 (BSEC 时间基准, ns)
+};
+
+enum RecordType : uint8_t {
+  kFrame = 1,              // 一帧 bme68x_data, 时间戳即 BSEC 输入时间戳
+  kMarker = 2,             // 人工标记 (如现场按键), 只有时间戳
+  kGap = 3,                // 间隔超过 uint32 微秒时的占位, 只推进时间
+  kDropped = 4,            // 录制队列满丢弃了帧: 位于丢帧之后的第一条记录之前, 丢失帧数见 dropped
+};
+
+struct Record {
+  uint8_t type;
+  uint8_t status;
+  uint8_t gasIndex;
+  uint8_t measIndex;
+  uint32_t dtUs;
+  union {
+    float temperature;
+    uint32_t dropped;      // kDropped: 此处丢失的帧数
+  };
+  float pressure;
+  float humidity;
+  float gasResistance;
+};
+
+static_assert(sizeof(FileHeader) == 16, "FileHeader layout");
+static_assert(sizeof(Record) == 24, "Record layout");
+
+} // namespace rawrec
@@ -0,0 +1,54 @@
+#pragma once
+// Host (native) 替身: Arduino 核心的最小子集, 时间来自 HostHal 的虚拟时钟。
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+inline void yield() {}
+
+class HardwareSerial {
+public:
+  void begin(unsigned long) {}
+  size_t print(const char *s);
+  size_t print(int v) { return printf("%d", v); }
+  size_t print(unsigned v) { return printf("%u", v); }
+  size_t print(float v) { return printf("%.2f", v); }
+  size_t println(const char *s);
+  size_t println() { return print("\n"); }
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+  int available(); // 输入来自命令行 --serial 脚本
+  int read();
+  void flush() { fflush(stdout); }
+};
+
+extern HardwareSerial Serial;
+
+// ESP32 的 CPU 周期计数器。主机上按 240 MHz 把 (虚拟时钟 + 实际耗时) 折算成周期:
+// 被 delay() 模拟的阻塞时间与真实 CPU 时间都会体现在阶段计时里。
+class EspClass {
+public:
+  uint32_t getCycleCount();
+  uint32_t getCpuFreqMHz() { return 240; }
+};
+
+extern EspClass ESP;
+
+// FreeRTOS 任务通知的最小子集 (ESP32 的 Arduino.h 会间接包含 FreeRTOS)。
+// 主机上只有一个线程: ulTaskNotifyTake() 把虚拟时钟快进到超时或下一个脚本输入 (按键/串口) 为止。
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef void *TaskHandle_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFu)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+void xTaskNotifyGive(TaskHandle_t task);
@@ -0,0 +1,167 @@
+// Host (native) 替身: 数据分区的 NOR flash 镜像。
+#include "HostHal.h"
+#include "esp_partition.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace host {
+
+// 与 partitions.csv 中的自定义数据分区一致 (地址只用于显示)
+static esp_partition_t gPartitions[] = {
+  {ESP_PARTITION_TYPE_DATA, 0x40, 0xFE0000, 0x10000, "bsec_cfg", false},
+  {ESP_PARTITION_TYPE_DATA, 0x41, 0xE60000, 0x180000, "samplelog", false},
+};
+static const size_t kPartitionCount = sizeof(gPartitions) / sizeof(gPartitions[0]);
+static std::vector<uint8_t> gImage[kPartitionCount];
+static bool gLoaded = false;
+static FILE *gFile = nullptr;          // 镜像文件, 各分区按上表顺序首尾相接
+static std::string gPath;              // flashReboot() 指定的镜像文件, 代替 --flash
+static bool gPathSet = false;
+static int64_t gCutBudget = -1;        // 断电前还能写入/擦除的字节数, < 0 = 不断电
+static bool gPoweredOff = false;
+static uint32_t gNoise = 0x9E3779B9u;  // 断点处字节的随机位
+
+static const uint64_t kEraseSectorUs = 45000;  // 典型 4 KB 扇区擦除时间
+static const uint64_t kWritePageUs = 700;      // 典型 256 B 页编程时间
+
+static const std::string &imagePath() { return gPathSet ? gPath : options().flashPath; }
+
+static size_t fileOffset(size_t part) {
+  size_t off = 0;
+  for (size_t i = 0; i < part; ++i) off += gPartitions[i].size;
+  return off;
+}
+
+static void flashLoad() {
+  gLoaded = true;
+  for (size_t i = 0; i < kPartitionCount; ++i) gImage[i].assign(gPartitions[i].size, 0xFF);
+  if (imagePath().empty()) return;
+  size_t loaded = 0;
+  gFile = fopen(imagePath().c_str(), "r+b");
+  if (gFile) {
+    while (loaded < kPartitionCount && fread(gImage[loaded].data(), 1, gImage[loaded].size(), gFile) == gImage[loaded].size()) ++loaded;
+  } else {
+    gFile = fopen(imagePath().c_str(), "w+b");
+    if (!gFile) return;
+  }
+  if (loaded == kPartitionCount) return;
+  // 新文件或旧版本 (分区较少) 的镜像: 整体写回一次, 补齐到当前分区表的大小
+  fseek(gFile, 0, SEEK_SET);
+  for (size_t i = 0; i < kPartitionCount; ++i) fwrite(gImage[i].data(), 1, gImage[i].size(), gFile);
+  fflush(gFile);
+}
+
+// 只写回改动的范围, 逐样本追加的日志分区不必每次重写整个镜像
+static void flashFlush(size_t part, size_t offset, size_t size) {
+  if (!gFile) return;
+  fseek(gFile, (long)(fileOffset(part) + offset), SEEK_SET);
+  fwrite(gImage[part].data() + offset, 1, size, gFile);
+  fflush(gFile);
+}
+
+static int partIndex(const esp_partition_t *p) {
+  if (!gLoaded) flashLoad();
+  for (size_t i = 0; i < kPartitionCount; ++i) {
+    if (p == &gPartitions[i]) return (int)i;
+  }
+  return -1;
+}
+
+// 本次操作在断电前能完成的字节数; 返回 size 表示不断电
+static size_t powerBudget(size_t size) {
+  if (gCutBudget < 0 || (uint64_t)gCutBudget >= size) {
+    if (gCutBudget >= 0) gCutBudget -= (int64_t)size;
+    return size;
+  }
+  size_t n = (size_t)gCutBudget;
+  gCutBudget = -1;
+  gPoweredOff = true;
+  return n;
+}
+
+static uint8_t noiseByte() {
+  gNoise ^= gNoise << 13;
+  gNoise ^= gNoise >> 17;
+  gNoise ^= gNoise << 5;
+  return (uint8_t)gNoise;
+}
+
+void flashPowerCutAfter(int64_t bytes) {
+  gCutBudget = bytes;
+}
+
+bool flashPoweredOff() {
+  return gPoweredOff;
+}
+
+void flashReboot(const char *path) {
+  if (gFile) fclose(gFile);
+  gFile = nullptr;
+  gLoaded = false;
+  gPoweredOff = false;
+  gCutBudget = -1;
+  if (path) {
+    gPath = path;
+    gPathSet = true;
+  }
+}
+
+} // namespace host
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char *label) {
+  for (size_t i = 0; i < host::kPartitionCount; ++i) {
+    const esp_partition_t &p = host::gPartitions[i];
+    if (p.type != type || (subtype != ESP_PARTITION_SUBTYPE_ANY && p.subtype != subtype)) continue;
+    if (label && strcmp(label, p.label) != 0) continue;
+    return &p;
+  }
+  return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *p, size_t offset, void *dst, size_t size) {
+  int i = host::partIndex(p);
+  if (i < 0 || offset + size > host::gImage[i].size()) return ESP_ERR_INVALID_SIZE;
+  memcpy(dst, host::gImage[i].data() + offset, size);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *p, size_t offset, const void *src, size_t size) {
+  int i = host::partIndex(p);
+  if (i < 0 || offset + size > host::gImage[i].size()) return ESP_ERR_INVALID_SIZE;
+  if (host::gPoweredOff) return ESP_FAIL;
+  uint8_t *img = host::gImage[i].data() + offset;
+  const uint8_t *s = (const uint8_t *)src;
+  size_t n = host::powerBudget(size);
+  for (size_t k = 0; k < n; ++k) img[k] &= s[k]; // NOR flash: 只能 1 -> 0
+  if (n < size) img[n] &= s[n] | host::noiseByte(); // 断电时正在编程的字节只有部分位生效
+  host::advanceUs((n + 255) / 256 * host::kWritePageUs);
+  host::flashFlush(i, offset, n < size ? n + 1 : size);
+  return n < size ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *p, size_t offset, size_t size) {
+  int i = host::partIndex(p);
+  if (i < 0 || offset + size > host::gImage[i].size()) return ESP_ERR_INVALID_SIZE;
+  if (offset % SPI_FLASH_SEC_SIZE || size % SPI_FLASH_SEC_SIZE) return ESP_ERR_INVALID_ARG;
+  if (host::gPoweredOff) return ESP_FAIL;
+  uint8_t *img = host::gImage[i].data() + offset;
+  size_t n = host::powerBudget(size);
+  memset(img, 0xFF, n);
+  if (n < size) img[n] |= host::noiseByte(); // 擦除中断: 其后的内容保持原样, 断点处的字节部分被擦除
+  host::advanceUs((n + SPI_FLASH_SEC_SIZE - 1) / SPI_FLASH_SEC_SIZE * host::kEraseSectorUs);
+  host::flashFlush(i, offset, n < size ? n + 1 : size);
+  return n < size ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t *p, size_t offset, size_t size, spi_flash_mmap_memory_t,
+                             const void **out_ptr, spi_flash_mmap_handle_t *out_handle) {
+  int i = host::partIndex(p);
+  if (i < 0 || offset + size > host::gImage[i].size()) return ESP_ERR_INVALID_SIZE;
+  *out_ptr = host::gImage[i].data() + offset;
+  *out_handle = 1;
+  return ESP_OK;
+}
+
+void spi_flash_munmap(spi_flash_mmap_handle_t) {}
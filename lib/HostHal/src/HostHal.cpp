@@ -0,0 +1,489 @@
+// Host (native) 运行时: 虚拟时钟、Serial/M5/Wire/Preferences 替身、合成环境与 main()。
+#include "HostHal.h"
+#include "Arduino.h"
+#include "M5Unified.h"
+#include "Wire.h"
+#include "Preferences.h"
+#include "esp_timer.h"
+#include <raw_record.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <stdlib.h>
+
+namespace host {
+
+static Options gOptions;
+static uint64_t gNowUs = 0;
+
+const Options &options() { return gOptions; }
+uint64_t nowUs() { return gNowUs; }
+void advanceUs(uint64_t us) { gNowUs += us; }
+int64_t wallClockSec() {
+  if (gOptions.epochSec == 0) return 0;
+  return gOptions.epochSec + (int64_t)((gNowUs / 1000ULL - gOptions.startMs) / 1000ULL);
+}
+
+static uint8_t gMuxMask = 0;
+static int gLastSite = kRouteNone;
+
+static const std::vector<SensorSite> &sites() {
+  static const std::vector<SensorSite> kDefault = {{-1, 0x76}}; // ENV Pro (BME688) 默认地址
+  return gOptions.sensors.empty() ? kDefault : gOptions.sensors;
+}
+
+static bool muxPresent() {
+  for (const SensorSite &s : sites()) {
+    if (s.channel >= 0) return true;
+  }
+  return false;
+}
+
+int i2cRoute(uint8_t addr) {
+  if (addr == kMuxAddr && muxPresent()) return kRouteMux;
+  const std::vector<SensorSite> &all = sites();
+  for (size_t i = 0; i < all.size(); ++i) {
+    if (all[i].addr != addr) continue;
+    if (all[i].channel < 0 || (gMuxMask & (1u << all[i].channel))) return (int)i;
+  }
+  return kRouteNone;
+}
+
+bool i2cDevicePresent(uint8_t addr) { return i2cRoute(addr) != kRouteNone; }
+void i2cSetMuxMask(uint8_t mask) { gMuxMask = mask; }
+int i2cLastSite() { return gLastSite; }
+void i2cSetLastSite(int site) { gLastSite = site; }
+
+// 确定性的小幅噪声 (不依赖 rand(), 保证每次运行结果一致)
+static float noise(uint64_t tMs, uint32_t salt) {
+  uint32_t x = (uint32_t)(tMs / 1000ULL) * 2654435761u ^ salt * 40503u;
+  x ^= x >> 13; x *= 0x5bd1e995u; x ^= x >> 15;
+  return ((x & 0xFFFF) / 65535.0f) - 0.5f;
+}
+
+EnvSample sampleEnvironment(uint64_t tMs, uint8_t site) {
+  const double kDayMs = 24.0 * 3600.0 * 1000.0;
+  const double kTwoPi = 6.283185307179586;
+  double day = (double)tMs / kDayMs;
+  uint32_t salt = site * 16u;
+
+  // HVAC: 每 45 分钟运行 15 分钟, 降温除湿
+  uint64_t hvacPhase = (tMs + site * 7ULL * 60ULL * 1000ULL) % (45ULL * 60ULL * 1000ULL);
+  bool hvacOn = hvacPhase < 15ULL * 60ULL * 1000ULL;
+
+  EnvSample s;
+  s.temperature = 24.0f + 0.4f * site + 1.5f * (float)sin(kTwoPi * day) - (hvacOn ? 1.2f : 0.0f) + 0.05f * noise(tMs, salt + 1);
+  s.humidity = 45.0f - 1.0f * site + 8.0f * (float)sin(kTwoPi * day + 1.0) - (hvacOn ? 6.0f : 0.0f) + 0.3f * noise(tMs, salt + 2);
+  s.pressure_Pa = 100800.0f + 300.0f * (float)sin(kTwoPi * day / 1.5) + 4.0f * noise(tMs, salt + 3);
+
+  // 气体阻值: 清洁空气阻值随时间缓慢漂移, 受温湿度影响, 每 3 小时一次 VOC 事件
+  float r0 = 60000.0f * (1.0f - 0.05f * site) * (float)(1.0 - 0.02 * day);
+  float r = r0 * expf(-0.03f * (s.humidity - 45.0f)) * expf(-0.02f * (s.temperature - 24.0f));
+  uint64_t evPhase = (tMs + site * 20ULL * 60ULL * 1000ULL) % (3ULL * 3600ULL * 1000ULL);
+  const uint64_t evStart = 3600ULL * 1000ULL;
+  const uint64_t evRamp = 60ULL * 1000ULL, evHold = 10ULL * 60ULL * 1000ULL, evFall = 5ULL * 60ULL * 1000ULL;
+  float dip = 0.0f;
+  if (evPhase >= evStart && evPhase < evStart + evRamp) {
+    dip = (float)(evPhase - evStart) / evRamp;
+  } else if (evPhase >= evStart + evRamp && evPhase < evStart + evRamp + evHold) {
+    dip = 1.0f;
+  } else if (evPhase >= evStart + evRamp + evHold && evPhase < evStart + evRamp + evHold + evFall) {
+    dip = 1.0f - (float)(evPhase - evStart - evRamp - evHold) / evFall;
+  }
+  r *= 1.0f - 0.45f * dip;
+  s.gas_Ohm = r * (1.0f + 0.01f * noise(tMs, salt + 4));
+  return s;
+}
+
+// ---- 回放 ----
+namespace replay {
+
+struct Frame {
+  int64_t tsNs;
+  bme68xData data;
+};
+static std::vector<Frame> gFrames;
+static size_t gNext = 0;
+static bool gActive = false;
+
+static bool load(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f) return false;
+  rawrec::FileHeader hdr;
+  bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 && hdr.magic == rawrec::kMagic &&
+            hdr.version == rawrec::kVersion && hdr.recordSize == sizeof(rawrec::Record);
+  int64_t ts = hdr.t0Ns;
+  rawrec::Record rec;
+  while (ok && fread(&rec, sizeof(rec), 1, f) == 1) {
+    ts += (int64_t)rec.dtUs * 1000;
+    if (rec.type != rawrec::kFrame) continue;
+    Frame fr{ts, {}};
+    fr.data.status = rec.status;
+    fr.data.gas_index = rec.gasIndex;
+    fr.data.meas_index = rec.measIndex;
+    fr.data.temperature = rec.temperature;
+    fr.data.pressure = rec.pressure;
+    fr.data.humidity = rec.humidity;
+    fr.data.gas_resistance = rec.gasResistance;
+    gFrames.push_back(fr);
+  }
+  fclose(f);
+  gActive = ok;
+  return ok;
+}
+
+bool active() { return gActive; }
+
+bool peekNs(int64_t &tsNs) {
+  if (gNext >= gFrames.size()) return false;
+  tsNs = gFrames[gNext].tsNs;
+  return true;
+}
+
+bool next(bme68xData &data, int64_t &tsNs) {
+  if (gNext >= gFrames.size()) return false;
+  data = gFrames[gNext].data;
+  tsNs = gFrames[gNext].tsNs;
+  ++gNext;
+  return true;
+}
+
+uint32_t framesServed() { return (uint32_t)gNext; }
+
+} // namespace replay
+
+// ---- Preferences 后备存储 ----
+static std::map<std::string, std::vector<uint8_t>> gNvs;
+
+static void nvsLoad() {
+  if (gOptions.nvsPath.empty()) return;
+  FILE *f = fopen(gOptions.nvsPath.c_str(), "rb");
+  if (!f) return;
+  uint32_t klen, vlen;
+  while (fread(&klen, 4, 1, f) == 1) {
+    std::string key(klen, '\0');
+    if (fread(&key[0], 1, klen, f) != klen || fread(&vlen, 4, 1, f) != 1) break;
+    std::vector<uint8_t> val(vlen);
+    if (fread(val.data(), 1, vlen, f) != vlen) break;
+    gNvs[key] = val;
+  }
+  fclose(f);
+}
+
+static void nvsFlush() {
+  if (gOptions.nvsPath.empty()) return;
+  FILE *f = fopen(gOptions.nvsPath.c_str(), "wb");
+  if (!f) return;
+  for (auto &kv : gNvs) {
+    uint32_t klen = kv.first.size(), vlen = kv.second.size();
+    fwrite(&klen, 4, 1, f);
+    fwrite(kv.first.data(), 1, klen, f);
+    fwrite(&vlen, 4, 1, f);
+    fwrite(kv.second.data(), 1, vlen, f);
+  }
+  fclose(f);
+}
+
+static std::vector<uint8_t> *nvsFind(const std::string &k) {
+  auto it = gNvs.find(k);
+  return it == gNvs.end() ? nullptr : &it->second;
+}
+
+static void parseArgs(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    auto next = [&]() -> const char * { return i + 1 < argc ? argv[++i] : ""; };
+    if (a == "--hours") {
+      gOptions.durationMs = (uint64_t)(atof(next()) * 3600.0 * 1000.0);
+    } else if (a == "--seconds") {
+      gOptions.durationMs = (uint64_t)(atof(next()) * 1000.0);
+    } else if (a == "--start-ms") {
+      gOptions.startMs = strtoull(next(), nullptr, 10);
+    } else if (a == "--quiet") {
+      gOptions.quiet = true;
+    } else if (a == "--nvs") {
+      gOptions.nvsPath = next();
+    } else if (a == "--record") {
+      gOptions.recordPath = next();
+    } else if (a == "--replay") {
+      gOptions.replayPath = next();
+    } else if (a == "--sensor") {
+      // 形如 0x77 (主总线) 或 3:0x76 (TCA9548A 通道 3)
+      std::string v = next();
+      size_t colon = v.find(':');
+      SensorSite site{-1, 0};
+      if (colon != std::string::npos) site.channel = (int8_t)atoi(v.c_str());
+      site.addr = (uint8_t)strtoul(v.c_str() + (colon == std::string::npos ? 0 : colon + 1), nullptr, 16);
+      gOptions.sensors.push_back(site);
+    } else if (a == "--flash") {
+      gOptions.flashPath = next();
+    } else if (a == "--config-dir") {
+      gOptions.configDir = next();
+    } else if (a == "--epoch") {
+      gOptions.epochSec = strtoll(next(), nullptr, 10);
+    } else if (a == "--press") {
+      // 形如 A@120: 第 120 秒按下 BtnA
+      const char *v = next();
+      if (v[0] && v[1] == '@') gOptions.presses.push_back({v[0], (uint64_t)(atof(v + 2) * 1000.0)});
+    } else if (a == "--serial") {
+      // 形如 "timing@3600": 第 3600 秒从串口收到一行 "timing"
+      std::string v = next();
+      size_t at = v.rfind('@');
+      if (at != std::string::npos) gOptions.serialInputs.push_back({v.substr(0, at), (uint64_t)(atof(v.c_str() + at + 1) * 1000.0)});
+    } else {
+      fprintf(stderr, "用法: %s [--hours H | --seconds S] [--start-ms MS] [--quiet] [--nvs FILE] [--press A@SEC]... [--serial CMD@SEC]... [--sensor [CH:]ADDR]... [--flash FILE] [--config-dir DIR] [--epoch SEC] [--record FILE | --replay FILE]\n", argv[0]);
+      exit(2);
+    }
+  }
+  if (!gOptions.replayPath.empty()) gOptions.sensors.clear(); // 录制文件只含一个传感器
+  std::stable_sort(gOptions.presses.begin(), gOptions.presses.end(),
+                   [](const ButtonPress &a, const ButtonPress &b) { return a.atMs < b.atMs; });
+  std::stable_sort(gOptions.serialInputs.begin(), gOptions.serialInputs.end(),
+                   [](const SerialInput &a, const SerialInput &b) { return a.atMs < b.atMs; });
+}
+
+} // namespace host
+
+// ---- Arduino 核心 ----
+HardwareSerial Serial;
+
+uint32_t millis() { return (uint32_t)(host::nowUs() / 1000ULL); }
+uint32_t micros() { return (uint32_t)host::nowUs(); }
+int64_t esp_timer_get_time() { return (int64_t)host::nowUs(); }
+void delay(uint32_t ms) { host::advanceUs((uint64_t)ms * 1000ULL); }
+void delayMicroseconds(uint32_t us) { host::advanceUs(us); }
+
+static std::string gSerialRx;
+static size_t gNextSerialInput = 0;
+
+int HardwareSerial::available() {
+  const auto &inputs = host::options().serialInputs;
+  while (gNextSerialInput < inputs.size() &&
+         inputs[gNextSerialInput].atMs <= host::nowMs() - host::options().startMs) {
+    gSerialRx += inputs[gNextSerialInput++].line + "\n";
+  }
+  return (int)gSerialRx.size();
+}
+
+int HardwareSerial::read() {
+  if (!available()) return -1;
+  int c = (uint8_t)gSerialRx[0];
+  gSerialRx.erase(0, 1);
+  return c;
+}
+
+size_t HardwareSerial::print(const char *s) {
+  if (host::options().quiet) return strlen(s);
+  return fputs(s, stdout) >= 0 ? strlen(s) : 0;
+}
+
+size_t HardwareSerial::println(const char *s) { return print(s) + print("\n"); }
+
+size_t HardwareSerial::printf(const char *fmt, ...) {
+  if (host::options().quiet) return 0;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vfprintf(stdout, fmt, ap);
+  va_end(ap);
+  return n < 0 ? 0 : (size_t)n;
+}
+
+EspClass ESP;
+
+// ---- FreeRTOS 任务通知 ----
+static uint32_t gNotifyCount = 0;
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+  if (gNotifyCount == 0 && ticksToWait > 0) {
+    // 快进到超时, 但不越过下一个脚本输入 (模拟按键/串口把任务提前唤醒)
+    uint64_t wakeMs = host::nowMs() + ticksToWait;
+    uint64_t base = host::options().startMs;
+    for (const auto &p : host::options().presses) {
+      if (p.atMs + base > host::nowMs()) { wakeMs = std::min<uint64_t>(wakeMs, p.atMs + base); break; }
+    }
+    for (const auto &in : host::options().serialInputs) {
+      if (in.atMs + base > host::nowMs()) { wakeMs = std::min<uint64_t>(wakeMs, in.atMs + base); break; }
+    }
+    host::advanceUs((wakeMs - host::nowMs()) * 1000ULL);
+  }
+  uint32_t count = gNotifyCount;
+  gNotifyCount = clearCountOnExit ? 0 : (count ? count - 1 : 0);
+  return count;
+}
+
+void xTaskNotifyGive(TaskHandle_t) { ++gNotifyCount; }
+
+uint32_t EspClass::getCycleCount() {
+  static const auto t0 = std::chrono::steady_clock::now();
+  uint64_t realNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+  return (uint32_t)((host::nowUs() * 1000ULL + realNs) * 240ULL / 1000ULL);
+}
+
+// ---- M5Unified ----
+const HostFont efontCN_10{"efontCN_10"};
+const HostFont efontCN_12{"efontCN_12"};
+const HostFont efontCN_16{"efontCN_16"};
+HostM5 M5;
+
+size_t HostDisplay::printf(const char *, ...) {
+  ++drawCalls;
+  return 0;
+}
+
+void HostM5::update() {
+  BtnA.pressed = BtnB.pressed = BtnC.pressed = false;
+  static size_t nextPress = 0;
+  const auto &presses = host::options().presses;
+  while (nextPress < presses.size() && presses[nextPress].atMs <= host::nowMs() - host::options().startMs) {
+    switch (presses[nextPress].button) {
+      case 'A': BtnA.pressed = true; break;
+      case 'B': BtnB.pressed = true; break;
+      case 'C': BtnC.pressed = true; break;
+    }
+    ++nextPress;
+  }
+}
+
+// ---- Wire ----
+TwoWire Wire;
+
+uint8_t TwoWire::endTransmission(bool) {
+  int route = host::i2cRoute(txAddr);
+  if (route == host::kRouteNone) return 2; // 2 = 地址 NACK
+  if (route == host::kRouteMux) {
+    if (txLen) host::i2cSetMuxMask(txBuf[0]);
+  } else {
+    host::i2cSetLastSite(route);
+  }
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t len) {
+  int route = host::i2cRoute(addr);
+  if (route < 0) return 0;
+  host::i2cSetLastSite(route);
+  rxLeft = len;
+  return len;
+}
+
+int TwoWire::read() {
+  if (!rxLeft) return -1;
+  --rxLeft;
+  return 0x61; // 只模拟 chip id 读取: BME688 的 chip id
+}
+
+// ---- Preferences ----
+bool Preferences::begin(const char *name, bool ro) {
+  if (started) return false;
+  ns = name;
+  readOnly = ro;
+  started = true;
+  return true;
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+  if (!started) return 0;
+  auto *v = host::nvsFind(ns + "/" + key);
+  return v ? v->size() : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+  if (!started) return 0;
+  auto *v = host::nvsFind(ns + "/" + key);
+  if (!v || v->size() > maxLen) return 0;
+  memcpy(buf, v->data(), v->size());
+  return v->size();
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+  if (!started || readOnly) return 0;
+  const uint8_t *p = (const uint8_t *)value;
+  host::gNvs[ns + "/" + key] = std::vector<uint8_t>(p, p + len);
+  host::nvsFlush();
+  return len;
+}
+
+size_t Preferences::getString(const char *key, char *value, size_t maxLen) {
+  if (!started) return 0;
+  auto *v = host::nvsFind(ns + "/" + key);
+  if (!v || v->size() + 1 > maxLen) return 0;
+  memcpy(value, v->data(), v->size());
+  value[v->size()] = '\0';
+  return v->size() + 1;
+}
+
+size_t Preferences::putString(const char *key, const char *value) {
+  return putBytes(key, value, strlen(value));
+}
+
+bool Preferences::isKey(const char *key) { return started && host::nvsFind(ns + "/" + key) != nullptr; }
+
+bool Preferences::remove(const char *key) {
+  if (!started || readOnly) return false;
+  bool erased = host::gNvs.erase(ns + "/" + key) > 0;
+  host::nvsFlush();
+  return erased;
+}
+
+// ---- 入口 ----
+void setup();
+void loop();
+
+#ifndef PIO_UNIT_TESTING
+int main(int argc, char **argv) {
+  host::parseArgs(argc, argv);
+#if !defined(USE_BSEC2)
+  // 回放由 Bsec2 替身按录制时间戳取帧; 轻量构建直接驱动 Bme68x 替身, 没有这条路径
+  if (!host::options().replayPath.empty()) {
+    fprintf(stderr, "[host] 轻量构建 (未定义 USE_BSEC2) 不支持 --replay\n");
+    return 1;
+  }
+#endif
+  if (!host::options().replayPath.empty()) {
+    if (!host::replay::load(host::options().replayPath.c_str())) {
+      fprintf(stderr, "[host] 无法读取回放文件 %s\n", host::options().replayPath.c_str());
+      return 1;
+    }
+    // 虚拟时钟从第一帧前 1 秒开始, 让 setup() 有时间完成
+    int64_t firstNs = 0;
+    if (host::replay::peekNs(firstNs) && firstNs > 1000000000LL) host::gOptions.startMs = (uint64_t)(firstNs / 1000000LL) - 1000ULL;
+  }
+  host::gNowUs = host::options().startMs * 1000ULL;
+  host::nvsLoad();
+
+  // 每次 loop() 至少消耗 1 ms 虚拟时间, 近似真机上 M5.update()/I2C 轮询的开销
+  const uint64_t kLoopTickUs = 1000;
+  const uint64_t endUs = host::nowUs() + host::options().durationMs * 1000ULL;
+  uint64_t iterations = 0;
+  auto wallStart = std::chrono::steady_clock::now();
+
+  setup();
+  if (host::replay::active()) {
+    // 回放: 帧之间没有可做的事, 直接把时钟拨到下一帧, 以 CPU 允许的最快速度跑完
+    int64_t nextNs = 0;
+    while (host::replay::peekNs(nextNs)) {
+      loop();
+      ++iterations;
+      uint64_t nextUs = (uint64_t)(nextNs / 1000LL);
+      host::gNowUs = nextUs > host::gNowUs + kLoopTickUs ? nextUs : host::gNowUs + kLoopTickUs;
+    }
+    loop();
+    ++iterations;
+    fprintf(stderr, "[host] 回放 %u 帧\n", host::replay::framesServed());
+  } else {
+    while (host::nowUs() < endUs) {
+      loop();
+      host::advanceUs(kLoopTickUs);
+      ++iterations;
+    }
+  }
+
+  double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  double simSec = (host::nowUs() - host::options().startMs * 1000ULL) / 1e6;
+  fprintf(stderr, "[host] 模拟 %.0f s, 用时 %.3f s (%.0fx 实时), loop() %llu 次, 绘图调用 %u 次\n",
+          simSec, wallSec, wallSec > 0 ? simSec / wallSec : 0.0, (unsigned long long)iterations,
+          M5.Display.drawCalls);
+  return 0;
+}
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+// Host (native) 构建的控制面: 虚拟时钟、命令行选项、环境模型。
+// 固件主要通过 Arduino/M5/Wire/Preferences/bsec2 的替身间接使用它, 只在 HOST_BUILD 下读取 options()。
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "bme68xLibrary.h"
+
+namespace host {
+
+struct ButtonPress {
+  char button;        // 'A' / 'B' / 'C'
+  uint64_t atMs;      // 虚拟时间
+};
+
+struct SerialInput {
+  std::string line;   // 不含换行, 送入时自动补 '\n'
+  uint64_t atMs;
+};
+
+// 传感器在 I2C 拓扑中的位置 (--sensor [通道:]地址)
+struct SensorSite {
+  int8_t channel;     // TCA9548A 通道 0..7, -1 表示直接挂在主总线
+  uint8_t addr;       // 0x76 / 0x77
+};
+
+struct Options {
+  uint64_t durationMs = 60ULL * 60ULL * 1000ULL; // 默认模拟 1 小时
+  uint64_t startMs = 0;                          // 虚拟时钟初值 (用于测试 millis() 回绕)
+  bool quiet = false;                            // 不向 stdout 输出 Serial
+  std::string nvsPath;                           // Preferences 持久化文件 (模拟热重启)
+  std::vector<ButtonPress> presses;
+  std::vector<SerialInput> serialInputs;
+  std::string recordPath;                        // 固件把原始帧录制到此文件
+  std::string replayPath;                        // 用录制文件代替合成环境, 回放完即退出
+  std::vector<SensorSite> sensors;               // 为空时只有主总线 0x76 (ENV Pro 默认), 回放时忽略
+  std::string flashPath;                         // 数据分区 (esp_partition) 镜像文件, 模拟重启后 flash 内容保留
+  std::string configDir;                         // 代替设备上的 /littlefs/bsec 与 /sd/bsec
+  int64_t epochSec = 0;                          // 启动时的墙上时间 (Unix 秒); 0 = RTC 未设置
+};
+
+const Options &options();
+
+// 虚拟时钟 (微秒)。delay()/delayMicroseconds() 只推进它, 不真正睡眠。
+uint64_t nowUs();
+inline uint64_t nowMs() { return nowUs() / 1000ULL; }
+void advanceUs(uint64_t us);
+// 墙上时间 (设备上由 RTC 设置的系统时间): --epoch 加上已模拟的时长; 未指定 --epoch 时为 0
+int64_t wallClockSec();
+
+// 合成的室内环境: 日周期温湿度、HVAC 循环、周期性 VOC 事件和缓慢的传感器漂移。
+struct EnvSample {
+  float temperature;   // °C
+  float humidity;      // %RH
+  float pressure_Pa;
+  float gas_Ohm;
+};
+// site 为传感器在拓扑中的下标: 各"房间"的事件相位与温湿度/阻值略有差异, site 0 即单传感器时的模型。
+EnvSample sampleEnvironment(uint64_t tMs, uint8_t site = 0);
+
+// flash 故障注入 (test/test_flash_log): 再写入/擦除 bytes 字节后断电 (< 0 取消)。断电时正在进行的写入/擦除只完成
+// 前面的部分, 断点处的字节只有部分位生效; 其后所有写入/擦除返回 ESP_FAIL, 直到 flashReboot()。
+void flashPowerCutAfter(int64_t bytes);
+bool flashPoweredOff();
+// 模拟重启: 丢弃内存中的镜像, 下次访问时从镜像文件重新载入, 恢复供电; path 非空时改用该文件 (代替 --flash)
+void flashReboot(const char *path = nullptr);
+
+// 回放 (--replay): Bsec2 替身按录制的时间戳取帧, main() 在帧之间直接跳过空闲时间。
+namespace replay {
+bool active();
+bool peekNs(int64_t &tsNs);                      // 下一帧的 BSEC 时间戳; 已回放完返回 false
+bool next(bme68xData &data, int64_t &tsNs);
+uint32_t framesServed();
+} // namespace replay
+
+// I2C 拓扑: 主总线上的传感器, 以及 kMuxAddr 处 TCA9548A 各通道后的传感器。
+// 只要 --sensor 指定了通道, 多路复用器就存在; 写入它的第一个字节即通道使能掩码。
+const uint8_t kMuxAddr = 0x70;
+// 按当前多路复用器路由, 访问 addr 会落到哪个传感器 (拓扑下标); kMuxAddr 返回 kRouteMux, 无应答返回 kRouteNone
+const int kRouteNone = -1;
+const int kRouteMux = -2;
+int i2cRoute(uint8_t addr);
+bool i2cDevicePresent(uint8_t addr);
+void i2cSetMuxMask(uint8_t mask);
+// 最近一次被应答的 I2C 访问落到的传感器
+int i2cLastSite();
+void i2cSetLastSite(int site);
+
+} // namespace host
@@ -0,0 +1,367 @@
+// Host (native) 替身: Bme68x 与 Bsec2 的行为模型。
+#include "HostHal.h"
+#if defined(USE_BSEC2)
+#include "bsec2.h"
+#else
+#include "bme68xLibrary.h"
+#endif
+
+// ---- Bme68x ----
+void bme68xDelayUs(uint32_t periodUs, void *) { delayMicroseconds(periodUs); }
+
+void Bme68x::begin(uint8_t i2cAddr, TwoWire &i2c, bme68x_delay_us_fptr_t) {
+  addr = i2cAddr;
+  readFn = nullptr;
+  writeFn = nullptr;
+  i2c.beginTransmission(addr);
+  status = i2c.endTransmission() == 0 ? BME68X_OK : BME68X_E_DEV_NOT_FOUND;
+  site = status == BME68X_OK ? host::i2cLastSite() : 0;
+  opMode = BME68X_SLEEP_MODE;
+  nFields = 0;
+}
+
+void Bme68x::begin(bme68xIntf, bme68x_read_fptr_t read, bme68x_write_fptr_t write, bme68x_delay_us_fptr_t, void *ptr) {
+  readFn = read;
+  writeFn = write;
+  intfPtr = ptr;
+  host::i2cSetLastSite(host::kRouteNone);
+  uint8_t chipId = 0;
+  bool ok = read(BME68X_REG_CHIP_ID, &chipId, 1, intfPtr) == BME68X_INTF_RET_SUCCESS && chipId == BME68X_CHIP_ID;
+  status = ok ? BME68X_OK : BME68X_E_DEV_NOT_FOUND;
+  site = ok ? host::i2cLastSite() : 0;
+  opMode = BME68X_SLEEP_MODE;
+  nFields = 0;
+}
+
+void Bme68x::setTPH(uint8_t osTemp, uint8_t osPres, uint8_t osHum) {
+  osT = osTemp;
+  osP = osPres;
+  osH = osHum;
+}
+
+void Bme68x::setHeaterProf(uint16_t temp, uint16_t dur) {
+  heatTemp = temp;
+  heatDur = dur;
+}
+
+void Bme68x::setHeaterProf(uint16_t *temp, uint16_t *mul, uint16_t sharedHeatrDur, uint8_t profileLen) {
+  profLen = profileLen > BME68X_MAX_HEATR_PROF_LEN ? BME68X_MAX_HEATR_PROF_LEN : profileLen;
+  for (uint8_t i = 0; i < profLen; ++i) {
+    profTemp[i] = temp[i];
+    profMul[i] = mul[i];
+  }
+  sharedDur = sharedHeatrDur;
+}
+
+void Bme68x::setOpMode(uint8_t mode) {
+  if (writeFn) {
+    // 经回调写 ctrl_meas; 若多路复用器没切到这颗传感器, 应答的是别的设备 (或无应答)
+    host::i2cSetLastSite(host::kRouteNone);
+    uint8_t reg = mode;
+    if (writeFn(BME68X_REG_CTRL_MEAS, &reg, 1, intfPtr) != BME68X_INTF_RET_SUCCESS || host::i2cLastSite() != site) {
+      status = BME68X_E_COM_FAIL;
+      return;
+    }
+    status = BME68X_OK;
+  }
+  opMode = mode;
+  nFields = 0;
+  readPos = 0;
+  if (mode == BME68X_FORCED_MODE) {
+    triggerUs = host::nowUs();
+  } else if (mode == BME68X_PARALLEL_MODE && profLen) {
+    parStep = 0;
+    parPrevTemp = profTemp[profLen - 1];
+    parStepEndUs = host::nowUs() + (uint64_t)profMul[0] * (getMeasDur(BME68X_PARALLEL_MODE) + sharedDur * 1000ULL);
+  }
+}
+
+uint32_t Bme68x::getMeasDur(uint8_t mode) {
+  // 与 bme68x_get_meas_dur() 相同的公式 (单位 us, 不含加热时间); 并行模式不需要唤醒时间
+  static const uint8_t cycles[6] = {0, 1, 2, 4, 8, 16};
+  uint32_t measCycles = cycles[osT] + cycles[osP] + cycles[osH];
+  return measCycles * 1963u + 477u * 4u + 477u * 5u + (mode == BME68X_PARALLEL_MODE ? 0u : 1000u);
+}
+
+// 并行模式: 每个加热步结束时产生一个字段, 传感器只保留最近 BME68X_N_MEAS 个。
+// 加热需要时间稳定: 与上一步温差越大, 需要的加热时间越长, 不够时字段没有 HEAT_STAB 标志。
+// 阻值随加热温度变化 (低温阻值高), 曲线形状随 VOC 事件变化, 这就是"气味指纹"。
+uint8_t Bme68x::fetchParallel() {
+  uint64_t now = host::nowUs();
+  uint64_t baseUs = getMeasDur(BME68X_PARALLEL_MODE) + sharedDur * 1000ULL;
+  while (now >= parStepEndUs) {
+    uint16_t temp = profTemp[parStep];
+    uint64_t heatUs = (uint64_t)profMul[parStep] * baseUs;
+    uint32_t diff = temp > parPrevTemp ? temp - parPrevTemp : parPrevTemp - temp;
+    bool stable = heatUs >= (10u + diff / 8u) * 1000ULL;
+    host::EnvSample s = host::sampleEnvironment(parStepEndUs / 1000ULL, (uint8_t)site);
+    host::EnvSample base = host::sampleEnvironment(0, (uint8_t)site);
+    float voc = base.gas_Ohm > 0 ? 1.0f - s.gas_Ohm / base.gas_Ohm : 0.0f; // VOC 使阻值下降的比例
+    if (voc < 0) voc = 0;
+    float shape = expf((320.0f - temp) / 120.0f) * (1.0f - voc * (temp < 250 ? 0.6f : 0.2f));
+
+    bme68xData &f = fields[(readPos + nFields) % BME68X_N_MEAS];
+    f = {};
+    f.status = BME68X_NEW_DATA_MSK | (temp >= 100 ? BME68X_GASM_VALID_MSK : 0) | (stable ? BME68X_HEAT_STAB_MSK : 0);
+    f.gas_index = parStep;
+    f.meas_index = measIndex++;
+    f.temperature = s.temperature;
+    f.humidity = s.humidity;
+    f.pressure = s.pressure_Pa;
+    f.gas_resistance = temp >= 100 ? s.gas_Ohm * shape : 0.0f;
+    if (nFields < BME68X_N_MEAS) {
+      ++nFields;
+    } else {
+      readPos = (readPos + 1) % BME68X_N_MEAS; // 覆盖最旧的字段
+    }
+
+    parPrevTemp = temp;
+    parStep = (parStep + 1) % profLen;
+    parStepEndUs += (uint64_t)profMul[parStep] * baseUs;
+  }
+  return nFields;
+}
+
+uint8_t Bme68x::fetchData() {
+  if (opMode == BME68X_PARALLEL_MODE) return profLen ? fetchParallel() : 0;
+  if (opMode != BME68X_FORCED_MODE) return nFields;
+  uint64_t readyUs = triggerUs + getMeasDur(BME68X_FORCED_MODE) + (uint64_t)heatDur * 1000ULL;
+  if (host::nowUs() < readyUs) return 0;
+
+  host::EnvSample s = host::sampleEnvironment(triggerUs / 1000ULL, (uint8_t)site);
+  bool heated = heatDur > 0 && heatTemp >= 200;
+  bme68xData &field = fields[0];
+  readPos = 0;
+  field = {};
+  field.status = BME68X_NEW_DATA_MSK | (heated ? (BME68X_GASM_VALID_MSK | BME68X_HEAT_STAB_MSK) : 0);
+  field.meas_index = measIndex++;
+  field.gas_wait = (uint8_t)(heatDur > 0xFF ? 0xFF : heatDur);
+  field.temperature = s.temperature;
+  field.humidity = s.humidity;
+  field.pressure = s.pressure_Pa;
+  field.gas_resistance = heated ? s.gas_Ohm : 0.0f;
+  opMode = BME68X_SLEEP_MODE; // forced 模式测完自动回到 sleep
+  nFields = 1;
+  return nFields;
+}
+
+// 按 meas_index 从旧到新依次取出, 返回剩余字段数
+uint8_t Bme68x::getData(bme68xData &data) {
+  if (nFields == 0) return 0;
+  data = fields[readPos];
+  readPos = (readPos + 1) % BME68X_N_MEAS;
+  return --nFields;
+}
+
+// ---- Bsec2 (轻量构建使用 src/raw_bsec.cpp) ----
+#if defined(USE_BSEC2)
+static const uint16_t kHeaterTemp = 320;   // BSEC LP/ULP 默认加热温度 (°C)
+static const uint16_t kHeaterDurMs = 197;  // BSEC LP/ULP 默认加热时长
+
+bool Bsec2::begin(uint8_t i2cAddr, TwoWire &i2c, bme68x_delay_us_fptr_t idleTask) {
+  sensor.begin(i2cAddr, i2c, idleTask);
+  return resetInstance();
+}
+
+bool Bsec2::begin(bme68xIntf intf, bme68x_read_fptr_t read, bme68x_write_fptr_t write, bme68x_delay_us_fptr_t idleTask, void *intfPtr) {
+  sensor.begin(intf, read, write, idleTask, intfPtr);
+  return resetInstance();
+}
+
+bool Bsec2::resetInstance() {
+  status = BSEC_OK;
+  if (sensor.checkStatus() == BME68X_ERROR) return false;
+  outputs = {};
+  nSubscribed = 0;
+  periodNs = 0;
+  learnedMs = 0;
+  gasRef = NAN;
+  configId = 0;
+  startedMs = getTimeMs();
+  return true;
+}
+
+bool Bsec2::updateSubscription(bsecSensor sensorList[], uint8_t nSensors, float sampleRate) {
+  if (sampleRate != BSEC_SAMPLE_RATE_ULP && sampleRate != BSEC_SAMPLE_RATE_LP &&
+      sampleRate != BSEC_SAMPLE_RATE_CONT && sampleRate != BSEC_SAMPLE_RATE_SCAN &&
+      sampleRate != BSEC_SAMPLE_RATE_DISABLED) {
+    status = BSEC_E_SU_SAMPLERATELIMITS;
+    return false;
+  }
+  // 与真实 BSEC 相同, 订阅是增量的: 只修改列出的虚拟传感器, 以 DISABLED 速率调用即取消订阅
+  for (uint8_t i = 0; i < nSensors; ++i) {
+    uint8_t k = 0;
+    while (k < nSubscribed && subscribed[k] != sensorList[i]) ++k;
+    if (sampleRate == BSEC_SAMPLE_RATE_DISABLED) {
+      if (k < nSubscribed) subscribed[k] = subscribed[--nSubscribed];
+    } else if (k == nSubscribed && nSubscribed < BSEC_NUMBER_OUTPUTS) {
+      subscribed[nSubscribed++] = sensorList[i];
+    }
+  }
+  int64_t newPeriod = sampleRate == BSEC_SAMPLE_RATE_DISABLED ? periodNs : (int64_t)llroundf(1000.0f / sampleRate) * 1000000LL;
+  if (nSubscribed == 0) newPeriod = 0;
+  if (newPeriod != periodNs) nextCallNs = getTimeMs() * 1000000LL;
+  periodNs = newPeriod;
+  status = BSEC_OK;
+  return true;
+}
+
+bool Bsec2::run() {
+  int64_t currTimeNs = getTimeMs() * 1000000LL;
+  if (host::replay::active()) {
+    // 回放: 调度由录制的时间戳决定, 数据不经过 Bme68x 替身
+    int64_t tsNs;
+    if (periodNs == 0 || !host::replay::peekNs(tsNs) || currTimeNs < tsNs) return true;
+    bme68xData data;
+    host::replay::next(data, tsNs);
+    status = BSEC_OK;
+    if (data.status & BME68X_GASM_VALID_MSK) return processData(tsNs, data);
+    return true;
+  }
+  if (periodNs == 0 || currTimeNs < nextCallNs) return true;
+
+  // 迟到超过周期的 1/16 (至少 50 ms) 视为调用时序违规, 与真实库的 bsecStatus=100 对应
+  int64_t lateNs = currTimeNs - nextCallNs;
+  int64_t toleranceNs = periodNs / 16 > 50000000LL ? periodNs / 16 : 50000000LL;
+  status = lateNs > toleranceNs ? BSEC_W_SC_CALL_TIMING_VIOLATION : BSEC_OK;
+  nextCallNs += periodNs;
+  if (nextCallNs <= currTimeNs) nextCallNs = currTimeNs + periodNs;
+
+  sensor.setTPH(BME68X_OS_2X, BME68X_OS_1X, BME68X_OS_1X);
+  sensor.setHeaterProf(kHeaterTemp, kHeaterDurMs);
+  sensor.setOpMode(BME68X_FORCED_MODE);
+  if (sensor.checkStatus() == BME68X_ERROR) return false;
+  delayMicroseconds(sensor.getMeasDur(BME68X_FORCED_MODE) + kHeaterDurMs * 1000u);
+
+  bme68xData data;
+  if (sensor.fetchData()) {
+    sensor.getData(data);
+    if (data.status & BME68X_GASM_VALID_MSK) {
+      if (!processData(currTimeNs, data)) return false;
+    }
+  }
+  return true;
+}
+
+bool Bsec2::processData(int64_t currTimeNs, const bme68xData &data) {
+  int64_t nowMs = currTimeNs / 1000000LL;
+  learnedMs += periodNs / 1000000LL;
+
+  // 参考阻值: 跟随上升、以约 12 小时时间常数缓慢回落
+  float gas = data.gas_resistance;
+  if (isnan(gasRef) || gas > gasRef) {
+    gasRef = gas;
+  } else {
+    float dtH = (float)(periodNs / 1000000LL) / 3600000.0f;
+    gasRef -= (gasRef - gas) * (dtH / 12.0f);
+  }
+
+  uint8_t accuracy = learnedMs < 5LL * 60000LL ? 0 : learnedMs < 30LL * 60000LL ? 1 : learnedMs < 120LL * 60000LL ? 2 : 3;
+  float ratio = 1.0f - gas / gasRef;
+  if (ratio < 0) ratio = 0;
+  float iaq = accuracy == 0 ? 50.0f : 25.0f + 300.0f * ratio;
+  float co2 = 500.0f + (iaq > 50.0f ? (iaq - 50.0f) * 10.0f : 0.0f);
+  float voc = 0.5f + (iaq > 50.0f ? (iaq - 50.0f) * 0.05f : 0.0f);
+  bool warm = learnedMs > 30LL * 60000LL;
+  int64_t stabilizeMs = warm ? 90000LL : 10LL * 60000LL;
+  float stabilized = (nowMs - startedMs) >= stabilizeMs ? 1.0f : 0.0f;
+  float runIn = warm ? 1.0f : 0.0f;
+
+  float compT = data.temperature - extTempOffset;
+  auto magnus = [](float t) { return expf(17.62f * t / (243.12f + t)); };
+  float compH = data.humidity * magnus(data.temperature) / magnus(compT);
+  if (compH > 100.0f) compH = 100.0f;
+
+  // 粗略的算法耗时模型: IAQ 系列输出共用一次气体算法, 加热补偿另算, 原始值只是拷贝
+  uint32_t costUs = 0;
+  bool iaqFamily = false, heatComp = false;
+  for (uint8_t i = 0; i < nSubscribed; ++i) {
+    switch (subscribed[i]) {
+      case BSEC_OUTPUT_IAQ: case BSEC_OUTPUT_STATIC_IAQ: case BSEC_OUTPUT_CO2_EQUIVALENT:
+      case BSEC_OUTPUT_BREATH_VOC_EQUIVALENT: case BSEC_OUTPUT_GAS_PERCENTAGE:
+        iaqFamily = true; costUs += 100; break;
+      case BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_TEMPERATURE: case BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_HUMIDITY:
+        heatComp = true; costUs += 20; break;
+      default: costUs += 10; break;
+    }
+  }
+  if (iaqFamily) costUs += 2000;
+  if (heatComp) costUs += 150;
+  host::advanceUs(costUs);
+
+  outputs.nOutputs = 0;
+  for (uint8_t i = 0; i < nSubscribed; ++i) {
+    bsecData &o = outputs.output[outputs.nOutputs++];
+    o = {};
+    o.time_stamp = currTimeNs;
+    o.sensor_id = (uint8_t)subscribed[i];
+    switch (subscribed[i]) {
+      case BSEC_OUTPUT_IAQ: o.signal = iaq; o.accuracy = accuracy; break;
+      case BSEC_OUTPUT_STATIC_IAQ: o.signal = iaq; o.accuracy = accuracy; break;
+      case BSEC_OUTPUT_CO2_EQUIVALENT: o.signal = co2; o.accuracy = accuracy; break;
+      case BSEC_OUTPUT_BREATH_VOC_EQUIVALENT: o.signal = voc; o.accuracy = accuracy; break;
+      case BSEC_OUTPUT_RAW_TEMPERATURE: o.signal = data.temperature; break;
+      case BSEC_OUTPUT_RAW_PRESSURE: o.signal = data.pressure; break;
+      case BSEC_OUTPUT_RAW_HUMIDITY: o.signal = data.humidity; break;
+      case BSEC_OUTPUT_RAW_GAS: o.signal = data.gas_resistance; break;
+      case BSEC_OUTPUT_STABILIZATION_STATUS: o.signal = stabilized; break;
+      case BSEC_OUTPUT_RUN_IN_STATUS: o.signal = runIn; break;
+      case BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_TEMPERATURE: o.signal = compT; break;
+      case BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_HUMIDITY: o.signal = compH; break;
+      case BSEC_OUTPUT_GAS_PERCENTAGE: o.signal = 100.0f * (1.0f - ratio); o.accuracy = accuracy; break;
+    }
+  }
+
+  if (newDataCallback) newDataCallback(data, outputs, *this);
+  return true;
+}
+
+bsecData Bsec2::getData(bsecSensor id) {
+  bsecData emp{};
+  for (uint8_t i = 0; i < outputs.nOutputs; ++i) {
+    if (outputs.output[i].sensor_id == id) return outputs.output[i];
+  }
+  return emp;
+}
+
+bool Bsec2::setConfig(const uint8_t *config) {
+  if (memcmp(config, "HCF", 3) != 0) {
+    status = BSEC_E_CONFIG_VERSIONMISMATCH;
+    return false;
+  }
+  uint32_t h = 2166136261u; // FNV-1a
+  for (uint32_t i = 0; i < BSEC_MAX_PROPERTY_BLOB_SIZE; ++i) h = (h ^ config[i]) * 16777619u;
+  configId = h ? h : 1;
+  learnedMs = 0;
+  gasRef = NAN;
+  status = BSEC_OK;
+  return true;
+}
+
+// state blob 布局: "HBS1" | learnedMs (int64) | gasRef (float) | configId (uint32) | 其余补零
+bool Bsec2::getState(uint8_t *state) {
+  memset(state, 0, BSEC_MAX_STATE_BLOB_SIZE);
+  memcpy(state, "HBS1", 4);
+  memcpy(state + 4, &learnedMs, sizeof(learnedMs));
+  memcpy(state + 12, &gasRef, sizeof(gasRef));
+  memcpy(state + 16, &configId, sizeof(configId));
+  return true;
+}
+
+bool Bsec2::setState(uint8_t *state) {
+  uint32_t id;
+  memcpy(&id, state + 16, sizeof(id));
+  if (memcmp(state, "HBS1", 4) != 0 || id != configId) return false;
+  memcpy(&learnedMs, state + 4, sizeof(learnedMs));
+  memcpy(&gasRef, state + 12, sizeof(gasRef));
+  return true;
+}
+
+int64_t Bsec2::getTimeMs() {
+  uint32_t timeMs = millis();
+  if (lastMillis > timeMs) ++ovfCounter;
+  lastMillis = timeMs;
+  return (int64_t)timeMs + ((int64_t)ovfCounter << 32);
+}
+
+#endif // USE_BSEC2
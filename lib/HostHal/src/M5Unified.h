@@ -0,0 +1,56 @@
+#pragma once
+// Host (native) 替身: M5Unified 中固件用到的显示/按键接口。绘图调用只计数, 不渲染。
+#include "Arduino.h"
+
+struct HostFont { const char *name; };
+extern const HostFont efontCN_10;
+extern const HostFont efontCN_12;
+extern const HostFont efontCN_16;
+
+enum : uint16_t {
+  TFT_BLACK = 0x0000,
+  TFT_WHITE = 0xFFFF,
+  TFT_GREEN = 0x07E0,
+  TFT_YELLOW = 0xFFE0,
+  TFT_CYAN = 0x07FF,
+  TFT_RED = 0xF800,
+};
+enum { TL_DATUM = 0 };
+
+class HostDisplay {
+public:
+  void fillScreen(uint16_t) { ++drawCalls; }
+  void fillRect(int16_t, int16_t, int16_t, int16_t, uint16_t) { ++drawCalls; }
+  void fillRoundRect(int16_t, int16_t, int16_t, int16_t, int16_t, uint16_t) { ++drawCalls; }
+  void drawRoundRect(int16_t, int16_t, int16_t, int16_t, int16_t, uint16_t) { ++drawCalls; }
+  void fillCircle(int16_t, int16_t, int16_t, uint16_t) { ++drawCalls; }
+  void setFont(const HostFont *) {}
+  void setTextDatum(int) {}
+  void setTextColor(uint16_t, uint16_t) {}
+  void setCursor(int16_t, int16_t) {}
+  size_t print(const char *s) { ++drawCalls; return strlen(s); }
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+  uint16_t color565(uint8_t r, uint8_t g, uint8_t b) {
+    return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+  }
+  uint32_t drawCalls = 0;
+};
+
+class HostButton {
+public:
+  bool wasPressed() const { return pressed; }
+  bool pressed = false;
+};
+
+struct HostM5Config {};
+
+class HostM5 {
+public:
+  HostM5Config config() { return {}; }
+  void begin(const HostM5Config &) {}
+  void update(); // 按命令行脚本 (--press) 产生按键事件
+  HostDisplay Display;
+  HostButton BtnA, BtnB, BtnC;
+};
+
+extern HostM5 M5;
@@ -0,0 +1,23 @@
+#pragma once
+// Host (native) 替身: NVS Preferences。数据在进程内保存, 指定 --nvs 时同步到文件以模拟重启。
+// 与 Arduino 实现相同: 已 begin() 的对象再次 begin() 返回 false, 未 begin() 时读写都失败。
+#include "Arduino.h"
+#include <string>
+
+class Preferences {
+public:
+  bool begin(const char *name, bool readOnly = false);
+  void end() { started = false; }
+  size_t getBytesLength(const char *key);
+  size_t getBytes(const char *key, void *buf, size_t maxLen);
+  size_t putBytes(const char *key, const void *value, size_t len);
+  size_t getString(const char *key, char *value, size_t maxLen);
+  size_t putString(const char *key, const char *value);
+  bool isKey(const char *key);
+  bool remove(const char *key);
+
+private:
+  std::string ns;
+  bool readOnly = false;
+  bool started = false;
+};
@@ -0,0 +1,28 @@
+#pragma once
+// Host (native) 替身: I2C 总线。只有 HostHal 拓扑中 (按当前多路复用器路由) 可达的地址会应答。
+#include "Arduino.h"
+
+class TwoWire {
+public:
+  bool begin() { return true; }
+  void beginTransmission(uint8_t addr) {
+    txAddr = addr;
+    txLen = 0;
+  }
+  size_t write(uint8_t b) {
+    if (txLen < sizeof(txBuf)) txBuf[txLen++] = b;
+    return 1;
+  }
+  uint8_t endTransmission(bool = true);
+  uint8_t requestFrom(uint8_t addr, uint8_t len);
+  int available() { return rxLeft; }
+  int read();
+
+private:
+  uint8_t txAddr = 0;
+  uint8_t txBuf[32];
+  uint8_t txLen = 0;
+  uint8_t rxLeft = 0;
+};
+
+extern TwoWire Wire;
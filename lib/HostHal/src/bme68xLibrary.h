@@ -0,0 +1,111 @@
+#pragma once
+// Host (native) 替身: Bosch BME68x Arduino 封装 (Bme68x 类) 的子集。
+// 测量值来自 HostHal 的合成环境, 测量时长按数据手册公式计算并推进虚拟时钟。
+#include "Arduino.h"
+#include "Wire.h"
+
+#define BME68X_OK INT8_C(0)
+#define BME68X_ERROR INT8_C(-1)
+#define BME68X_WARNING INT8_C(1)
+#define BME68X_E_COM_FAIL INT8_C(-2)
+#define BME68X_E_DEV_NOT_FOUND INT8_C(-3)
+
+#define BME68X_CHIP_ID UINT8_C(0x61)
+#define BME68X_REG_CHIP_ID UINT8_C(0xd0)
+#define BME68X_REG_CTRL_MEAS UINT8_C(0x74)
+
+#define BME68X_I2C_ADDR_LOW UINT8_C(0x76)
+#define BME68X_I2C_ADDR_HIGH UINT8_C(0x77)
+
+#define BME68X_SLEEP_MODE UINT8_C(0)
+#define BME68X_FORCED_MODE UINT8_C(1)
+#define BME68X_PARALLEL_MODE UINT8_C(2)
+#define BME68X_SEQUENTIAL_MODE UINT8_C(3)
+
+#define BME68X_OS_NONE UINT8_C(0)
+#define BME68X_OS_1X UINT8_C(1)
+#define BME68X_OS_2X UINT8_C(2)
+#define BME68X_OS_4X UINT8_C(3)
+#define BME68X_OS_8X UINT8_C(4)
+#define BME68X_OS_16X UINT8_C(5)
+
+#define BME68X_FILTER_OFF UINT8_C(0)
+
+#define BME68X_NEW_DATA_MSK UINT8_C(0x80)
+#define BME68X_GASM_VALID_MSK UINT8_C(0x20)
+#define BME68X_HEAT_STAB_MSK UINT8_C(0x10)
+#define BME68X_VALID_DATA UINT8_C(0xB0)
+
+#define BME68X_N_MEAS UINT8_C(3)             // 传感器内的数据字段数: 并行模式下来不及读取的字段会被覆盖
+#define BME68X_MAX_HEATR_PROF_LEN UINT8_C(10)
+
+enum bme68x_intf { BME68X_SPI_INTF, BME68X_I2C_INTF };
+typedef enum bme68x_intf bme68xIntf;
+
+#define BME68X_INTF_RET_TYPE int8_t
+#define BME68X_INTF_RET_SUCCESS INT8_C(0)
+typedef BME68X_INTF_RET_TYPE (*bme68x_read_fptr_t)(uint8_t reg_addr, uint8_t *reg_data, uint32_t length, void *intf_ptr);
+typedef BME68X_INTF_RET_TYPE (*bme68x_write_fptr_t)(uint8_t reg_addr, const uint8_t *reg_data, uint32_t length, void *intf_ptr);
+typedef void (*bme68x_delay_us_fptr_t)(uint32_t period, void *intf_ptr);
+
+struct bme68x_data {
+  uint8_t status;
+  uint8_t gas_index;
+  uint8_t meas_index;
+  uint8_t res_heat;
+  uint8_t idac;
+  uint8_t gas_wait;
+  float temperature;
+  float pressure;
+  float humidity;
+  float gas_resistance;
+};
+typedef struct bme68x_data bme68xData;
+
+void bme68xDelayUs(uint32_t periodUs, void *intfPtr);
+
+class Bme68x {
+public:
+  int8_t status = BME68X_OK;
+
+  void begin(uint8_t i2cAddr, TwoWire &i2c, bme68x_delay_us_fptr_t idleTask = bme68xDelayUs);
+  // 自定义总线 (如经 I2C 多路复用器): 读写都通过回调, 替身会校验回调确实路由到了 begin() 时找到的那颗传感器
+  void begin(bme68xIntf intf, bme68x_read_fptr_t read, bme68x_write_fptr_t write, bme68x_delay_us_fptr_t idleTask, void *intfPtr);
+  int8_t checkStatus() const {
+    if (status < BME68X_OK) return BME68X_ERROR;
+    if (status > BME68X_OK) return BME68X_WARNING;
+    return BME68X_OK;
+  }
+  void setTPH(uint8_t osTemp = BME68X_OS_2X, uint8_t osPres = BME68X_OS_16X, uint8_t osHum = BME68X_OS_1X);
+  void setFilter(uint8_t) {}
+  void setHeaterProf(uint16_t temp, uint16_t dur);
+  // 并行模式: 第 i 步加热到 temp[i], 持续 mul[i] 个时间基 (TPH 测量 + sharedHeatrDur ms)
+  void setHeaterProf(uint16_t *temp, uint16_t *mul, uint16_t sharedHeatrDur, uint8_t profileLen);
+  void setOpMode(uint8_t opMode);
+  uint32_t getMeasDur(uint8_t opMode = BME68X_SLEEP_MODE);
+  uint8_t fetchData();
+  uint8_t getData(bme68xData &data);
+
+private:
+  uint8_t fetchParallel();
+
+  uint8_t addr = 0;
+  int site = 0;                      // HostHal 拓扑中的下标, 决定合成环境
+  bme68x_read_fptr_t readFn = nullptr;
+  bme68x_write_fptr_t writeFn = nullptr;
+  void *intfPtr = nullptr;
+  uint8_t osT = BME68X_OS_2X, osP = BME68X_OS_16X, osH = BME68X_OS_1X;
+  uint16_t heatTemp = 0, heatDur = 0;
+  uint16_t profTemp[BME68X_MAX_HEATR_PROF_LEN] = {}, profMul[BME68X_MAX_HEATR_PROF_LEN] = {};
+  uint16_t sharedDur = 0;
+  uint8_t profLen = 0;
+  uint8_t opMode = BME68X_SLEEP_MODE;
+  uint64_t triggerUs = 0;
+  uint8_t measIndex = 0;
+  uint64_t parStepEndUs = 0;         // 并行模式: 当前加热步结束 (产生字段) 的时刻
+  uint8_t parStep = 0;
+  uint16_t parPrevTemp = 0;
+  bme68xData fields[BME68X_N_MEAS]{};
+  uint8_t nFields = 0;
+  uint8_t readPos = 0;
+};
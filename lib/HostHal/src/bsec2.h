@@ -0,0 +1,111 @@
+#pragma once
+// Host (native) 替身: Bosch BSEC2 Arduino 封装 (Bsec2 类) 的子集。
+// 不包含真正的 BSEC 算法: IAQ/CO2eq/VOCeq 由一个简单的气体阻值模型给出, 只求调用时序
+// (next_call、采样率、状态 blob、回调) 与真实库一致, 便于在主机上验证采集循环。
+#include "Arduino.h"
+#include "Wire.h"
+#include "bme68xLibrary.h"
+
+typedef int32_t bsec_library_return_t;
+#define BSEC_OK 0
+#define BSEC_W_SC_CALL_TIMING_VIOLATION 100
+#define BSEC_E_SU_SAMPLERATELIMITS (-16)
+#define BSEC_E_CONFIG_FAIL (-32)
+#define BSEC_E_CONFIG_VERSIONMISMATCH (-33)
+
+#define BSEC_SAMPLE_RATE_DISABLED (65535.0f)
+#define BSEC_SAMPLE_RATE_ULP (0.0033333f)
+#define BSEC_SAMPLE_RATE_CONT (1.0f)
+#define BSEC_SAMPLE_RATE_LP (0.33333f)
+#define BSEC_SAMPLE_RATE_SCAN (0.055556f)
+
+#define BSEC_MAX_STATE_BLOB_SIZE (221)
+#define BSEC_MAX_PROPERTY_BLOB_SIZE (2277)
+#define BSEC_INSTANCE_SIZE (3272)
+#define BSEC_NUMBER_OUTPUTS (30)
+
+#define TEMP_OFFSET_LP (1.3255f)
+#define TEMP_OFFSET_ULP (0.466f)
+
+typedef enum {
+  BSEC_OUTPUT_IAQ = 1,
+  BSEC_OUTPUT_STATIC_IAQ = 2,
+  BSEC_OUTPUT_CO2_EQUIVALENT = 3,
+  BSEC_OUTPUT_BREATH_VOC_EQUIVALENT = 4,
+  BSEC_OUTPUT_RAW_TEMPERATURE = 6,
+  BSEC_OUTPUT_RAW_PRESSURE = 7,
+  BSEC_OUTPUT_RAW_HUMIDITY = 8,
+  BSEC_OUTPUT_RAW_GAS = 9,
+  BSEC_OUTPUT_STABILIZATION_STATUS = 12,
+  BSEC_OUTPUT_RUN_IN_STATUS = 13,
+  BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_TEMPERATURE = 14,
+  BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_HUMIDITY = 15,
+  BSEC_OUTPUT_GAS_PERCENTAGE = 21,
+} bsec_virtual_sensor_t;
+
+typedef bsec_virtual_sensor_t bsecSensor;
+
+typedef struct {
+  float sample_rate;
+  uint8_t sensor_id;
+} bsec_sensor_configuration_t;
+
+typedef struct {
+  int64_t time_stamp;
+  float signal;
+  uint8_t signal_dimensions;
+  uint8_t sensor_id;
+  uint8_t accuracy;
+} bsec_output_t;
+
+typedef bsec_output_t bsecData;
+
+typedef struct {
+  bsecData output[BSEC_NUMBER_OUTPUTS];
+  uint8_t nOutputs;
+} bsecOutputs;
+
+class Bsec2;
+typedef void (*bsecCallback)(const bme68xData data, const bsecOutputs outputs, const Bsec2 bsec);
+
+class Bsec2 {
+public:
+  Bme68x sensor;
+  bsec_library_return_t status = BSEC_OK;
+
+  bool begin(uint8_t i2cAddr, TwoWire &i2c, bme68x_delay_us_fptr_t idleTask = bme68xDelayUs);
+  bool begin(bme68xIntf intf, bme68x_read_fptr_t read, bme68x_write_fptr_t write, bme68x_delay_us_fptr_t idleTask, void *intfPtr);
+  // 多实例时每个对象需要独立的算法内存 (替身不使用)
+  void allocateMemory(uint8_t (&memBlock)[BSEC_INSTANCE_SIZE]) { (void)memBlock; }
+  bool updateSubscription(bsecSensor sensorList[], uint8_t nSensors, float sampleRate = BSEC_SAMPLE_RATE_ULP);
+  bool run();
+  void attachCallback(bsecCallback callback) { newDataCallback = callback; }
+  const bsecOutputs *getOutputs() { return outputs.nOutputs ? &outputs : nullptr; }
+  bsecData getData(bsecSensor id);
+  bool getState(uint8_t *state);
+  bool setState(uint8_t *state);
+  // 与真实库相同, 总是读取 BSEC_MAX_PROPERTY_BLOB_SIZE 字节。替身要求 blob 以 "HCF" 开头 (模拟 BSEC 的版本/完整性检查),
+  // 并把配置指纹写进状态 blob: 在另一个配置下学到的状态会被 setState() 拒绝
+  bool setConfig(const uint8_t *config);
+  void setTemperatureOffset(float tempOffset) { extTempOffset = tempOffset; }
+  int64_t getTimeMs();
+
+private:
+  bool resetInstance();
+  bool processData(int64_t currTimeNs, const bme68xData &data);
+
+  bsecCallback newDataCallback = nullptr;
+  bsecOutputs outputs{};
+  bsecSensor subscribed[BSEC_NUMBER_OUTPUTS];
+  uint8_t nSubscribed = 0;
+  int64_t periodNs = 0;
+  int64_t nextCallNs = 0;
+  float extTempOffset = 0.0f;
+  uint32_t ovfCounter = 0;
+  uint32_t lastMillis = 0;
+  // 简化的 IAQ 模型状态 (会写入 state blob)
+  int64_t learnedMs = 0;
+  int64_t startedMs = -1;
+  float gasRef = NAN;
+  uint32_t configId = 0;   // 0 = 库默认配置
+};
@@ -0,0 +1,37 @@
+#pragma once
+// Host (native) 替身: ESP-IDF 分区 API 的子集。分区表固定 (见 HostFlash.cpp), 内容是内存中的 NOR flash 镜像,
+// 指定 --flash FILE 时同步到文件以模拟重启。与真实 NOR flash 相同: 擦除按 4 KB 扇区置 0xFF, 写入只能把 1 变成 0;
+// mmap 直接返回镜像内的指针 (相当于写入后 cache 已刷新)。擦除/写入按典型 SPI flash 速度推进虚拟时钟;
+// 断电故障注入见 HostHal.h 的 flashPowerCutAfter()。
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_SIZE 0x104
+
+#define SPI_FLASH_SEC_SIZE 4096
+
+typedef enum { ESP_PARTITION_TYPE_APP = 0x00, ESP_PARTITION_TYPE_DATA = 0x01 } esp_partition_type_t;
+typedef enum { ESP_PARTITION_SUBTYPE_ANY = 0xff } esp_partition_subtype_t;
+typedef enum { SPI_FLASH_MMAP_DATA, SPI_FLASH_MMAP_INST } spi_flash_mmap_memory_t;
+typedef uint32_t spi_flash_mmap_handle_t;
+
+typedef struct {
+  esp_partition_type_t type;
+  uint8_t subtype;
+  uint32_t address;
+  uint32_t size;
+  char label[17];
+  bool encrypted;
+} esp_partition_t;
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char *label);
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size);
+esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, size_t size, spi_flash_mmap_memory_t memory,
+                             const void **out_ptr, spi_flash_mmap_handle_t *out_handle);
+void spi_flash_munmap(spi_flash_mmap_handle_t handle);
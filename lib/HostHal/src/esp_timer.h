@@ -0,0 +1,5 @@
+#pragma once
+// Host (native) 替身: ESP-IDF 的 64 位单调微秒计时, 取自虚拟时钟。
+#include <stdint.h>
+
+int64_t esp_timer_get_time();
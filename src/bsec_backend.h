@@ -0,0 +1,8 @@
+#pragma once
+// 算法后端: 定义 USE_BSEC2 时使用 Bosch BSEC2 库 (IAQ/CO2eq/VOCeq、状态保存、AI-Studio 配置);
+// 未定义时使用 raw_bsec.h 中接口相同的 forced 模式直驱, 只输出温湿压与气体阻值, 不链接 BSEC 库。
+#if defined(USE_BSEC2)
+#include <bsec2.h>
+#else
+#include "raw_bsec.h"
+#endif
@@ -0,0 +1,210 @@
+#include "bsec_config.h"
+
+#if defined(USE_BSEC2)
+#include <dirent.h>
+#include <stdio.h>
+#if defined(HOST_BUILD)
+#include <HostHal.h>
+#endif
+
+BsecConfigStore bsecConfigs;
+
+static const char *PARTITION_LABEL = "bsec_cfg";
+static const char *CONFIG_EXT = ".bcfg";
+
+// 配置文件目录: LittleFS 优先, 其次 SD 卡 (均为 stdio 路径)
+static uint8_t configDirs(const char *dirs[2]) {
+#if defined(HOST_BUILD)
+  if (host::options().configDir.empty()) return 0;
+  dirs[0] = host::options().configDir.c_str();
+  return 1;
+#else
+  dirs[0] = "/littlefs/bsec";
+  dirs[1] = "/sd/bsec";
+  return 2;
+#endif
+}
+
+static bool validHeader(const bsecCfg::FileHeader &h, uint32_t maxSize) {
+  return h.magic == bsecCfg::kMagic && h.size > 0 && h.size <= BSEC_MAX_PROPERTY_BLOB_SIZE && h.size <= maxSize &&
+         memchr(h.name, '\0', bsecCfg::kNameLen) != nullptr;
+}
+
+void BsecConfigStore::begin() {
+  part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, PARTITION_LABEL);
+  if (!part) {
+    Serial.println("[配置] 没有 bsec_cfg 分区, 配置将从文件读入 RAM");
+    return;
+  }
+  const void *ptr = nullptr;
+  if (esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &ptr, &mapHandle) != ESP_OK) {
+    Serial.println("[配置] bsec_cfg 分区映射失败");
+    part = nullptr;
+    return;
+  }
+  mapped = (const uint8_t *)ptr;
+  slots = (uint8_t)(part->size / SLOT_SIZE);
+}
+
+const bsecCfg::FileHeader *BsecConfigStore::slotHeader(uint8_t i) const {
+  if (!mapped || i >= slots) return nullptr;
+  const uint8_t *base = mapped + (uint32_t)i * SLOT_SIZE;
+  const bsecCfg::FileHeader *h = (const bsecCfg::FileHeader *)base;
+  if (!validHeader(*h, SLOT_SIZE - sizeof(bsecCfg::FileHeader))) return nullptr;
+  if (bsecCfg::crc32(base + sizeof(bsecCfg::FileHeader), h->size) != h->crc32) return nullptr;
+  return h;
+}
+
+int BsecConfigStore::findSlot(const char *name) const {
+  for (uint8_t i = 0; i < slots; ++i) {
+    const bsecCfg::FileHeader *h = slotHeader(i);
+    if (h && strcmp(h->name, name) == 0) return i;
+  }
+  return -1;
+}
+
+bool BsecConfigStore::findFile(const char *name, char *path, size_t len) const {
+  const char *dirs[2];
+  uint8_t n = configDirs(dirs);
+  for (uint8_t i = 0; i < n; ++i) {
+    snprintf(path, len, "%s/%s%s", dirs[i], name, CONFIG_EXT);
+    FILE *f = fopen(path, "rb");
+    if (f) {
+      fclose(f);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BsecConfigStore::readFile(const char *path, uint8_t *&buf, uint32_t &bytes) const {
+  buf = nullptr;
+  FILE *f = fopen(path, "rb");
+  if (!f) return false;
+  bsecCfg::FileHeader h;
+  bool ok = fread(&h, sizeof(h), 1, f) == 1 && validHeader(h, SLOT_SIZE - sizeof(h));
+  if (ok) {
+    // setConfig() 总是读取 BSEC_MAX_PROPERTY_BLOB_SIZE 字节, 不足部分补零
+    buf = (uint8_t *)calloc(1, sizeof(h) + BSEC_MAX_PROPERTY_BLOB_SIZE);
+    ok = buf && fread(buf + sizeof(h), 1, h.size, f) == h.size &&
+         bsecCfg::crc32(buf + sizeof(h), h.size) == h.crc32;
+  }
+  fclose(f);
+  if (!ok) {
+    Serial.printf("[配置] %s 无效或校验失败\n", path);
+    free(buf);
+    buf = nullptr;
+    return false;
+  }
+  memcpy(buf, &h, sizeof(h));
+  bytes = sizeof(h) + h.size;
+  return true;
+}
+
+int BsecConfigStore::install(const char *name) {
+  if (!part) return -1;
+  char path[96];
+  if (!findFile(name, path, sizeof(path))) {
+    Serial.printf("[配置] 找不到 %s%s\n", name, CONFIG_EXT);
+    return -1;
+  }
+  uint8_t *buf;
+  uint32_t bytes;
+  if (!readFile(path, buf, bytes)) return -1;
+  // 槽位名以文件名为准, 容器内的名字只作参考
+  bsecCfg::FileHeader *h = (bsecCfg::FileHeader *)buf;
+  memset(h->name, 0, bsecCfg::kNameLen);
+  strncpy(h->name, name, bsecCfg::kNameLen - 1);
+
+  int slot = findSlot(name);
+  for (uint8_t i = 0; slot < 0 && i < slots; ++i) {
+    if (!slotHeader(i)) slot = i; // 空槽位或已损坏
+  }
+  if (slot < 0) {
+    Serial.printf("[配置] %u 个槽位已满, 先用 config remove 删除一个\n", slots);
+    free(buf);
+    return -1;
+  }
+  uint32_t offset = (uint32_t)slot * SLOT_SIZE;
+  bool ok = esp_partition_erase_range(part, offset, SLOT_SIZE) == ESP_OK &&
+            esp_partition_write(part, offset, buf, bytes) == ESP_OK && slotHeader(slot) != nullptr;
+  free(buf);
+  if (!ok) {
+    Serial.printf("[配置] 写入槽位 %d 失败\n", slot);
+    return -1;
+  }
+  Serial.printf("[配置] %s 已安装到槽位 %d (%u 字节)\n", name, slot, (unsigned)(bytes - sizeof(bsecCfg::FileHeader)));
+  return slot;
+}
+
+bool BsecConfigStore::remove(const char *name) {
+  int slot = findSlot(name);
+  if (slot < 0) return false;
+  return esp_partition_erase_range(part, (uint32_t)slot * SLOT_SIZE, SLOT_SIZE) == ESP_OK;
+}
+
+bool BsecConfigStore::prepare(const char *name, const char *keep) {
+  if (part) return findSlot(name) >= 0 || install(name) >= 0;
+
+  // 没有分区: 读入 RAM; 已读入的直接使用, 否则替换一份不是 keep 的缓冲
+  uint8_t idx = RAM_BLOBS;
+  for (uint8_t i = 0; i < RAM_BLOBS; ++i) {
+    const bsecCfg::FileHeader *h = (const bsecCfg::FileHeader *)ramBlobs[i];
+    if (h && strcmp(h->name, name) == 0) return true;
+    if (idx == RAM_BLOBS && (!h || !keep || strcmp(h->name, keep) != 0)) idx = i;
+  }
+  char path[96];
+  if (!findFile(name, path, sizeof(path))) {
+    Serial.printf("[配置] 找不到 %s%s\n", name, CONFIG_EXT);
+    return false;
+  }
+  uint8_t *buf;
+  uint32_t bytes;
+  if (!readFile(path, buf, bytes)) return false;
+  bsecCfg::FileHeader *h = (bsecCfg::FileHeader *)buf;
+  memset(h->name, 0, bsecCfg::kNameLen);
+  strncpy(h->name, name, bsecCfg::kNameLen - 1);
+  free(ramBlobs[idx]);
+  ramBlobs[idx] = buf;
+  return true;
+}
+
+const uint8_t *BsecConfigStore::acquire(const char *name, uint32_t &crc) const {
+  const uint8_t *base = nullptr;
+  int slot = findSlot(name);
+  if (slot >= 0) base = mapped + (uint32_t)slot * SLOT_SIZE;
+  for (uint8_t i = 0; !base && i < RAM_BLOBS; ++i) {
+    if (ramBlobs[i] && strcmp(((const bsecCfg::FileHeader *)ramBlobs[i])->name, name) == 0) base = ramBlobs[i];
+  }
+  if (!base) return nullptr;
+  crc = ((const bsecCfg::FileHeader *)base)->crc32;
+  return base + sizeof(bsecCfg::FileHeader);
+}
+
+void BsecConfigStore::print(const char *active) const {
+  Serial.printf("=== BSEC 配置 (当前: %s) ===\n", active);
+  if (part) {
+    Serial.printf("分区 %s: %u 个槽位 x %u KB (mmap)\n", PARTITION_LABEL, slots, (unsigned)(SLOT_SIZE / 1024));
+    for (uint8_t i = 0; i < slots; ++i) {
+      const bsecCfg::FileHeader *h = slotHeader(i);
+      if (h) Serial.printf("  [%u] %-19s %5u 字节 crc=%08x%s\n", i, h->name, (unsigned)h->size, (unsigned)h->crc32,
+                           strcmp(h->name, active) == 0 ? " *" : "");
+    }
+  }
+  const char *dirs[2];
+  uint8_t n = configDirs(dirs);
+  for (uint8_t i = 0; i < n; ++i) {
+    DIR *d = opendir(dirs[i]);
+    if (!d) continue;
+    Serial.printf("%s:\n", dirs[i]);
+    while (struct dirent *e = readdir(d)) {
+      size_t len = strlen(e->d_name);
+      size_t extLen = strlen(CONFIG_EXT);
+      if (len > extLen && strcmp(e->d_name + len - extLen, CONFIG_EXT) == 0) Serial.printf("  %s\n", e->d_name);
+    }
+    closedir(d);
+  }
+  Serial.println("================");
+}
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+// BSEC 配置仓库: 运行时从 LittleFS/SD 加载 AI-Studio 导出的配置 (容器格式见 include/bsec_config_file.h), 部署新模型不必重新烧录。
+// 配置先安装到专用 flash 分区 "bsec_cfg" 的槽位, 分区整体 mmap, setConfig() 直接读 flash 映射, RAM 中不保留副本;
+// 分区表里没有该分区时退回为从文件读入堆缓冲 (保留当前与待切换的两份)。每次使用前都校验 CRC, 损坏的槽位/文件不会交给 BSEC。
+// 读写文件与 flash 的方法 (prepare/install/remove/print) 只在 loop() 中调用, 且不与采集任务的重建同时进行;
+// 采集任务 (与 Bsec2 同一任务) 只调用 acquire(), 它只查找已准备好的槽位/缓冲。只在 USE_BSEC2 构建中存在。
+#include <Arduino.h>
+#include "bsec_backend.h"
+#include <esp_partition.h>
+#include <bsec_config_file.h>
+
+static const char BSEC_CONFIG_DEFAULT[] = "default"; // 库内置配置, 不经过仓库
+
+class BsecConfigStore {
+public:
+  // 查找并映射 "bsec_cfg" 分区
+  void begin();
+  // 让 acquire(name) 可用: 槽位中没有时从文件安装; 没有分区时读入 RAM, 只保留 keep 的那份 (可为 nullptr)
+  bool prepare(const char *name, const char *keep);
+  // 按名称取得可直接交给 Bsec2::setConfig() 的指针 (其后至少 BSEC_MAX_PROPERTY_BLOB_SIZE 字节可读);
+  // 只查找 prepare() 准备好的槽位/缓冲, 没有时返回 nullptr。crc 输出 blob 的 CRC-32, 用作该配置的标识
+  const uint8_t *acquire(const char *name, uint32_t &crc) const;
+  // 把 LittleFS/SD 上的 <name>.bcfg 写入槽位 (同名覆盖); 返回槽位号, 失败返回 -1
+  int install(const char *name);
+  bool remove(const char *name);
+  void print(const char *active) const;
+
+private:
+  static const uint32_t SLOT_SIZE = 2 * SPI_FLASH_SEC_SIZE;
+  static const uint8_t RAM_BLOBS = 2;
+
+  const bsecCfg::FileHeader *slotHeader(uint8_t i) const; // 槽位有效 (magic/大小/CRC) 时返回映射地址
+  int findSlot(const char *name) const;
+  bool findFile(const char *name, char *path, size_t len) const;
+  // 读入容器并校验, 成功时 buf 为 malloc 的 [头 | blob | 补零到 BSEC_MAX_PROPERTY_BLOB_SIZE]
+  bool readFile(const char *path, uint8_t *&buf, uint32_t &bytes) const;
+
+  const esp_partition_t *part = nullptr;
+  const uint8_t *mapped = nullptr;
+  spi_flash_mmap_handle_t mapHandle = 0;
+  uint8_t slots = 0;
+  uint8_t *ramBlobs[RAM_BLOBS] = {}; // 没有分区时的回退: [头 (名称为文件名) | blob], 见 readFile()
+};
+
+extern BsecConfigStore bsecConfigs;
@@ -0,0 +1,47 @@
+#include "bsec_consumers.h"
+#include <Arduino.h>
+
+int8_t BsecConsumers::add(const char *name, BsecOutputMask mask) {
+  if (count >= MAX_CONSUMERS) return -1;
+  names[count] = name;
+  declared[count] = mask;
+  needs[count].store(mask, std::memory_order_relaxed);
+  changed.store(true, std::memory_order_release);
+  return (int8_t)count++;
+}
+
+void BsecConsumers::set(int8_t id, BsecOutputMask mask) {
+  if (id < 0 || id >= (int8_t)count) return;
+  if (needs[id].exchange(mask, std::memory_order_relaxed) != mask) changed.store(true, std::memory_order_release);
+}
+
+int8_t BsecConsumers::find(const char *name) const {
+  for (uint8_t i = 0; i < count; ++i) {
+    if (strcmp(names[i], name) == 0) return (int8_t)i;
+  }
+  return -1;
+}
+
+BsecOutputMask BsecConsumers::wanted() const {
+  BsecOutputMask all = 0;
+  for (uint8_t i = 0; i < count; ++i) all |= needs[i].load(std::memory_order_relaxed);
+  return all;
+}
+
+static void printMask(BsecOutputMask mask) {
+  for (uint8_t id = 0; id < 32; ++id) {
+    if (mask & (1UL << id)) Serial.printf(" %u", id);
+  }
+  Serial.println();
+}
+
+void BsecConsumers::print(BsecOutputMask active) const {
+  Serial.println("=== BSEC 订阅 (虚拟传感器 id) ===");
+  for (uint8_t i = 0; i < count; ++i) {
+    Serial.printf("%-10s:", names[i]);
+    printMask(needs[i].load(std::memory_order_relaxed));
+  }
+  Serial.print("当前订阅  :");
+  printMask(active);
+  Serial.println("================================");
+}
@@ -0,0 +1,34 @@
+#pragma once
+// 按消费者声明 BSEC 订阅: 每个消费者 (界面、记录、网络上报、告警...) 登记自己读取的虚拟传感器,
+// 实际订阅为所有消费者需求的并集 (且只取 sensor_values.h 映射表中有字段的输出)。
+// 消费者在 setup() 中 add(), 之后可在 loop() 中随时 set() 修改需求; 采集任务在下一次迭代中 takeChanged() 并重新订阅,
+// BSEC 只计算有人读的输出。
+#include <stdint.h>
+#include <atomic>
+#include "sensor_values.h"
+
+class BsecConsumers {
+public:
+  static const uint8_t MAX_CONSUMERS = 12;
+
+  // 返回消费者 id, 失败返回 -1
+  int8_t add(const char *name, BsecOutputMask needs);
+  // 修改需求; needs = 0 表示暂时不需要任何输出
+  void set(int8_t id, BsecOutputMask needs);
+  // 暂停/恢复: 恢复时回到 add() 时声明的需求
+  void pause(int8_t id, bool paused) { set(id, paused ? 0 : declared[id]); }
+  int8_t find(const char *name) const;
+
+  BsecOutputMask wanted() const;
+  // 采集任务调用: 自上次调用以来需求是否变化
+  bool takeChanged() { return changed.exchange(false, std::memory_order_acq_rel); }
+
+  void print(BsecOutputMask active) const;
+
+private:
+  const char *names[MAX_CONSUMERS]{};
+  BsecOutputMask declared[MAX_CONSUMERS]{};
+  std::atomic<BsecOutputMask> needs[MAX_CONSUMERS]{};
+  uint8_t count = 0;
+  std::atomic<bool> changed{false};
+};
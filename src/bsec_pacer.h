@@ -0,0 +1,41 @@
+#pragma once
+// 推算 BSEC 下一次需要调用 run() 的时刻, 让采集任务在两次测量之间休眠而不是空转。
+// Bsec2 封装把 bsec_sensor_control() 给出的 next_call 设为私有, 这里用与 BSEC 相同的方式重建它:
+// 以第一条输出的时间戳为锚点, 每次输出后按采样周期顺延 (而不是"本次输出时间 + 周期", 否则唤醒延迟会逐次累积)。
+#include <stdint.h>
+
+class BsecPacer {
+public:
+  // 周期不变时保留锚点 (例如只改变订阅的输出)
+  void setPeriodMs(uint32_t ms) {
+    if (ms == periodMs) return;
+    periodMs = ms;
+    nextDueMs = -1;
+  }
+  void reset() { nextDueMs = -1; }
+
+  // 在 BSEC 回调中调用, tsMs 为输出时间戳
+  void onOutput(int64_t tsMs) {
+    if (periodMs == 0) return;
+    if (nextDueMs < 0 || tsMs - nextDueMs > (int64_t)periodMs / 2 || tsMs < nextDueMs - (int64_t)periodMs / 2) {
+      nextDueMs = tsMs + periodMs; // 首次或偏离过大: 重新锚定
+    } else {
+      nextDueMs += periodMs;
+    }
+  }
+
+  // 距下一次到期还有多少毫秒; 0 表示现在就该调用 (或尚未锚定, 需要轮询)
+  uint32_t msUntilDue(int64_t nowMs) {
+    if (nextDueMs < 0) return 0;
+    // 到期后迟迟没有输出 (测量无效等): 跳到下一个周期, 避免一直轮询
+    while (nowMs >= nextDueMs + (int64_t)MISSED_GRACE_MS) nextDueMs += periodMs;
+    return nowMs >= nextDueMs ? 0 : (uint32_t)(nextDueMs - nowMs);
+  }
+
+  int64_t nextDue() const { return nextDueMs; }
+
+private:
+  static const uint32_t MISSED_GRACE_MS = 500;
+  uint32_t periodMs = 0;
+  int64_t nextDueMs = -1;
+};
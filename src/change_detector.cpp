@@ -0,0 +1,78 @@
+#include "change_detector.h"
+
+static const float END_FRACTION = 0.25f;
+static const int64_t MAX_STEP_MS = 30LL * 60LL * 1000LL;
+static const int64_t MAX_EVENT_MS = 2LL * 60LL * 60LL * 1000LL; // 超过即视为水平漂移而非事件, 以当前值重设参考
+
+void ChangeDetector::configure(int8_t direction, float kNoise, float threshold, float tau) {
+  dir = direction >= 0 ? 1 : -1;
+  k = kNoise;
+  h = threshold;
+  tauMin = tau;
+  reset();
+}
+
+void ChangeDetector::reset() {
+  ref = NAN;
+  S = 0.0f;
+  lastTsMs = lastZeroMs = -1;
+  active = false;
+  peak = 0.0f;
+  belowSinceMs = -1;
+}
+
+bool ChangeDetector::update(int64_t tsMs, float x, ChangeEvent &ev) {
+  if (isnan(x)) return false;
+  if (lastTsMs >= 0 && tsMs < lastTsMs) reset(); // 时间回退 (重新初始化/回放): 从头开始
+  int64_t dtMs = lastTsMs >= 0 ? tsMs - lastTsMs : 0;
+  lastTsMs = tsMs;
+  if (isnan(ref)) {
+    ref = x;
+    lastZeroMs = tsMs;
+    return false;
+  }
+
+  float dev = dir * (x - ref);
+  if (active) {
+    // 事件中: 参考水平冻结, 记录峰值, 等待回落
+    if (dev > peak) peak = dev;
+    float endLevel = fminf(k, peak * END_FRACTION);
+    bool expired = tsMs - onsetMs > MAX_EVENT_MS;
+    if (dev > endLevel && !expired) {
+      belowSinceMs = -1;
+      return false;
+    }
+    if (belowSinceMs < 0) belowSinceMs = tsMs;
+    if (tsMs - belowSinceMs < END_HOLD_MS && !expired) return false;
+    if (expired) ref = x;
+    active = false;
+    S = 0.0f;
+    lastZeroMs = tsMs;
+    ev.start = false;
+    ev.timestampMs = belowSinceMs;
+    ev.onsetMs = onsetMs;
+    ev.magnitude = peak;
+    belowSinceMs = -1;
+    return true;
+  }
+
+  S += dev - k;
+  if (S <= 0.0f) {
+    S = 0.0f;
+    lastZeroMs = tsMs;
+    if (dtMs > MAX_STEP_MS) dtMs = MAX_STEP_MS;
+    ref += (1.0f - expf(-(dtMs / 60000.0f) / tauMin)) * (x - ref);
+    return false;
+  }
+  if (S < h) return false;
+
+  active = true;
+  onsetMs = lastZeroMs;
+  peak = dev;
+  belowSinceMs = -1;
+  ev.start = true;
+  ev.timestampMs = tsMs;
+  ev.onsetMs = onsetMs;
+  ev.magnitude = dev;
+  return true;
+}
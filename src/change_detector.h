@@ -0,0 +1,46 @@
+#pragma once
+// 流式变点检测: 单侧 CUSUM (Page-Hinkley 形式), 每个样本 O(1), 用于把 VOC 事件记成带时间戳的开始/结束事件。
+// - 参考水平为信号的慢速指数平均, 只在没有累积 (S = 0) 时更新, 事件的爬升段不会把参考拉走;
+// - S = max(0, S + 偏离 - k), 超过 h 即报告事件开始; 起点估计取 S 最近一次为 0 的样本 (CUSUM 的变点估计);
+// - 偏离回落到峰值的 1/4 (且不超过 k) 以下并保持 END_HOLD_MS 后报告结束, 幅度为事件期间的最大偏离;
+//   持续超过 2 小时仍未回落则视为水平漂移 (如湿度骤变后补偿模型尚未学好), 同样报告结束并以当前值重设参考。
+// k/h 按"每个样本"计: 采样越慢, 同样幅度的变化越快越过 h, 在 ULP 下一两个样本即可确认大的变化。
+#include <Arduino.h>
+
+struct ChangeEvent {
+  uint8_t sensor;
+  uint8_t channel;       // EVENT_CHANNELS 下标
+  bool start;            // true = 开始, false = 结束
+  int64_t timestampMs;   // 检测到 (开始) 或恢复 (结束) 的样本时间戳
+  int64_t onsetMs;       // 估计的变化起点
+  float magnitude;       // 开始: 确认时的偏离; 结束: 整个事件的最大偏离 (与通道同单位)
+};
+
+class ChangeDetector {
+public:
+  // direction: +1 检测上升, -1 检测下降; k = 允许的偏离 (噪声), h = 报警阈值, tauMin = 参考水平时间常数
+  void configure(int8_t direction, float k, float h, float tauMin);
+  void reset();
+
+  // 推进一个样本; 产生事件时写入 ev (sensor/channel 由调用方填写) 并返回 true
+  bool update(int64_t tsMs, float x, ChangeEvent &ev);
+
+  bool inEvent() const { return active; }
+  float reference() const { return ref; }
+  float statistic() const { return S; }
+
+private:
+  static const int64_t END_HOLD_MS = 60000;
+
+  int8_t dir = -1;
+  float k = 0.0f, h = 0.0f, tauMin = 30.0f;
+
+  float ref = NAN;
+  float S = 0.0f;
+  int64_t lastTsMs = -1;
+  int64_t lastZeroMs = -1;    // S 最近一次为 0 的时刻
+  bool active = false;
+  int64_t onsetMs = 0;
+  float peak = 0.0f;
+  int64_t belowSinceMs = -1;  // 偏离回落到结束门限以下的起点
+};
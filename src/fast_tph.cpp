@@ -0,0 +1,93 @@
+#include "fast_tph.h"
+
+// 温度/湿度 1x, 气压 4x: 一次测量约 17 ms, 气压噪声比 1x 低一半
+static const uint8_t OS_TEMP = BME68X_OS_1X;
+static const uint8_t OS_PRES = BME68X_OS_4X;
+static const uint8_t OS_HUM = BME68X_OS_1X;
+
+bool FastTph::start(Bme68x &d, uint8_t sensor, uint16_t rateHz, int64_t nowUs) {
+  stop();
+  d.setTPH(OS_TEMP, OS_PRES, OS_HUM);
+  measUs = d.getMeasDur(BME68X_FORCED_MODE);
+  if (d.checkStatus() == BME68X_ERROR) return false;
+  if (rateHz > FAST_TPH_MAX_HZ) rateHz = FAST_TPH_MAX_HZ;
+  periodUs = 1000000LL / (rateHz ? rateHz : 1);
+  if (periodUs < measUs) periodUs = measUs;
+  dev = &d;
+  sensorIdx = sensor;
+  dueUs = nowUs;
+  measuring = false;
+  startUs = nowUs;
+  samples = yielded = errors = 0;
+  return true;
+}
+
+void FastTph::stop() {
+  dev = nullptr;
+  measuring = false;
+}
+
+bool FastTph::poll(int64_t nowUs, uint32_t bsecDueMs, FastTphSample &out) {
+  if (!dev || nowUs < dueUs) return false;
+
+  if (measuring) {
+    if (dev->fetchData() == 0) {
+      if (nowUs - triggerUs > (int64_t)(measUs + TIMEOUT_US)) {
+        ++errors;
+        measuring = false;
+        dueUs = nowUs + periodUs;
+      } else {
+        dueUs = nowUs + 1000;
+      }
+      return false;
+    }
+    bme68xData f;
+    dev->getData(f);
+    measuring = false;
+    // 按触发时刻排定下一次; 采集任务被其他传感器阻塞过就从现在开始, 不补发
+    dueUs = triggerUs + periodUs > nowUs ? triggerUs + periodUs : nowUs;
+    if (!(f.status & BME68X_NEW_DATA_MSK)) return false;
+    out.sensor = sensorIdx;
+    out.timestampMs = triggerUs / 1000;
+    out.temperature = f.temperature;
+    out.humidity = f.humidity;
+    out.pressure_hPa = f.pressure / 100.0f;
+    ++samples;
+    return true;
+  }
+
+  if ((int64_t)bsecDueMs * 1000 < (int64_t)(measUs + GUARD_US)) {
+    // BSEC 即将测量 (或正在等它的输出): 让出本周期, BSEC 输出后再继续
+    ++yielded;
+    dueUs = nowUs + periodUs;
+    return false;
+  }
+  dev->setTPH(OS_TEMP, OS_PRES, OS_HUM);
+  dev->setHeaterProf(0, 0);
+  dev->setOpMode(BME68X_FORCED_MODE);
+  if (dev->checkStatus() == BME68X_ERROR) {
+    ++errors;
+    dueUs = nowUs + periodUs;
+    return false;
+  }
+  measuring = true;
+  triggerUs = nowUs;
+  dueUs = nowUs + measUs;
+  return false;
+}
+
+uint32_t FastTph::msUntilDue(int64_t nowUs) const {
+  if (!dev) return UINT32_MAX;
+  return dueUs > nowUs ? (uint32_t)((dueUs - nowUs + 999) / 1000) : 0;
+}
+
+void FastTph::print(int64_t nowUs) const {
+  Serial.printf("=== 高速温湿压 (%s) ===\n", dev ? "运行中" : "已停止");
+  if (dev) {
+    float sec = (nowUs - startUs) / 1e6f;
+    Serial.printf("传感器 #%u, 目标 %.1f Hz, 实际 %.1f Hz, 每次测量 %.1f ms\n", sensorIdx, hz(),
+                  sec > 0 ? samples / sec : 0.0f, measUs / 1000.0f);
+  }
+  Serial.printf("样本 %u, 为 BSEC 让出 %u 次, 失败 %u 次\n", samples, yielded, errors);
+  Serial.println("================");
+}
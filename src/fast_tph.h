@@ -0,0 +1,53 @@
+#pragma once
+// 高速温湿压: 在两次 BSEC 气体测量之间, 对一颗传感器做加热器关闭的 forced 测量, 最高数十 Hz,
+// 用于门窗开关、空调启停这类亚秒级的气压/湿度变化。
+// - 不加热: 加热时长为 0 (bme68x 封装没有单独关闭加热的接口), 气体字段无效、不使用;
+// - 触发与读出分两步, 测量期间不阻塞采集任务, 其他传感器照常 run();
+// - 只在距离该传感器的 BSEC 截止时刻还够 "测量 + 保护间隔" 时触发; 截止前读出, BSEC 的调用既不迟到也读不到本路径的字段。
+//   BSEC 每次测量都会重新设置过采样与加热参数, 这里改动的配置不需要恢复。
+#include <Arduino.h>
+#include <bme68xLibrary.h>
+
+static const uint16_t FAST_TPH_MAX_HZ = 50;
+
+struct FastTphSample {
+  uint8_t sensor;
+  int64_t timestampMs;   // 触发时刻
+  float temperature;
+  float humidity;
+  float pressure_hPa;
+};
+
+class FastTph {
+public:
+  // 采集任务调用; hz 超过测量本身允许的上限时按上限运行
+  bool start(Bme68x &dev, uint8_t sensor, uint16_t hz, int64_t nowUs);
+  void stop();
+  bool active() const { return dev != nullptr; }
+  uint8_t sensor() const { return sensorIdx; }
+  float hz() const { return 1e6f / periodUs; }
+
+  // 采集任务调用, 须在该传感器的 BSEC run() 之前: bsecDueMs 为距 BSEC 下一次调用的毫秒数。
+  // 读出一次测量时写入 out 并返回 true
+  bool poll(int64_t nowUs, uint32_t bsecDueMs, FastTphSample &out);
+  uint32_t msUntilDue(int64_t nowUs) const;
+
+  void print(int64_t nowUs) const;
+
+private:
+  static const uint32_t GUARD_US = 10000;    // 读出与 BSEC 截止之间至少留出的时间
+  static const uint32_t TIMEOUT_US = 50000;  // 超过测量时长这么久仍无数据 (传感器被重新初始化等): 放弃本次
+
+  Bme68x *dev = nullptr;
+  uint8_t sensorIdx = 0;
+  int64_t periodUs = 0;
+  uint32_t measUs = 0;
+  int64_t dueUs = 0;
+  int64_t triggerUs = 0;
+  bool measuring = false;
+
+  int64_t startUs = 0;
+  uint32_t samples = 0;
+  uint32_t yielded = 0;   // 因 BSEC 即将测量而让出的周期
+  uint32_t errors = 0;
+};
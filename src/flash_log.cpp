@@ -0,0 +1,165 @@
+#include "flash_log.h"
+#include <bsec_config_file.h>  // bsecCfg::crc32
+#include <esp_timer.h>
+#include <string.h>
+
+static const uint32_t MIN_BLOCKS = 4;
+
+static uint32_t headerCrc(uint32_t magic, uint32_t seq, uint32_t eraseCount) {
+  uint32_t words[3] = {magic, seq, eraseCount};
+  return bsecCfg::crc32((const uint8_t *)words, sizeof(words));
+}
+
+bool FlashLog::readHeader(uint32_t b, BlockHeader &h) const {
+  if (esp_partition_read(part, (size_t)b * BLOCK_BYTES, &h, sizeof(h)) != ESP_OK) return false;
+  return h.magic == MAGIC && h.seq != 0 && h.crc == headerCrc(h.magic, h.seq, h.eraseCount);
+}
+
+bool FlashLog::begin(const char *label) {
+  part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+  if (!part || part->size / BLOCK_BYTES < MIN_BLOCKS) {
+    part = nullptr;
+    return false;
+  }
+  int64_t t0 = esp_timer_get_time();
+  nBlocks = part->size / BLOCK_BYTES;
+  seq = maxErase = 0;
+  head = nBlocks - 1; // 空分区从第 0 块开始
+  for (uint32_t b = 0; b < nBlocks; ++b) {
+    BlockHeader h;
+    if (!readHeader(b, h)) continue;
+    if (h.seq > seq) {
+      seq = h.seq;
+      head = b;
+    }
+    if (h.eraseCount > maxErase) maxErase = h.eraseCount;
+  }
+  scanUs = (uint32_t)(esp_timer_get_time() - t0);
+  open = false;
+  records = erased = failures = 0;
+  bytes = 0;
+  return true;
+}
+
+// 擦除环形顺序的下一块并写入块头。失败的块被跳过 (序号照常递增), 下一次追加再试后面的块
+bool FlashLog::openNext() {
+  open = false;
+  uint32_t b = (head + 1) % nBlocks;
+  head = b;
+  BlockHeader old;
+  uint32_t eraseCount = readHeader(b, old) ? old.eraseCount + 1 : (maxErase ? maxErase : 1); // 块头损坏时按已知最大次数估计
+  if (esp_partition_erase_range(part, (size_t)b * BLOCK_BYTES, BLOCK_BYTES) != ESP_OK) {
+    ++failures;
+    return false;
+  }
+  ++erased;
+  BlockHeader h;
+  h.magic = MAGIC;
+  h.seq = ++seq;
+  h.eraseCount = eraseCount;
+  h.crc = headerCrc(h.magic, h.seq, h.eraseCount);
+  if (esp_partition_write(part, (size_t)b * BLOCK_BYTES, &h, sizeof(h)) != ESP_OK) {
+    ++failures;
+    return false;
+  }
+  if (eraseCount > maxErase) maxErase = eraseCount;
+  offset = sizeof(BlockHeader);
+  open = true;
+  return true;
+}
+
+bool FlashLog::append(uint8_t type, const void *data, uint16_t len) {
+  if (!part || type == 0 || type == 0xFF || len > MAX_PAYLOAD) return false;
+  if (!open || offset + RECORD_OVERHEAD + len > BLOCK_BYTES) {
+    if (!openNext()) return false;
+  }
+  uint8_t buf[RECORD_OVERHEAD + MAX_PAYLOAD];
+  RecordHeader r;
+  r.len = len;
+  r.type = type;
+  r.check = (uint8_t)~type;
+  memcpy(buf, &r, sizeof(r));
+  memcpy(buf + sizeof(r), data, len);
+  uint32_t crc = bsecCfg::crc32(buf, sizeof(r) + len);
+  memcpy(buf + sizeof(r) + len, &crc, sizeof(crc));
+  uint32_t size = RECORD_OVERHEAD + len;
+  if (esp_partition_write(part, (size_t)head * BLOCK_BYTES + offset, buf, size) != ESP_OK) {
+    // 写了一半的记录读取时校验失败, 该块就此结束
+    ++failures;
+    open = false;
+    return false;
+  }
+  offset += size;
+  ++records;
+  bytes += size;
+  return true;
+}
+
+FlashLogCursor FlashLog::read() const {
+  FlashLogCursor c;
+  c.log = this;
+  c.visited = part ? 0 : UINT32_MAX;
+  return c;
+}
+
+FlashLogStats FlashLog::stats() const {
+  FlashLogStats s;
+  if (!part) return s;
+  s.blocks = nBlocks;
+  for (uint32_t b = 0; b < nBlocks; ++b) {
+    BlockHeader h;
+    if (!readHeader(b, h)) continue;
+    if (!s.valid || h.seq < s.oldestSeq) s.oldestSeq = h.seq;
+    if (!s.valid || h.seq > s.newestSeq) s.newestSeq = h.seq;
+    if (!s.valid || h.eraseCount < s.minErase) s.minErase = h.eraseCount;
+    if (!s.valid || h.eraseCount > s.maxErase) s.maxErase = h.eraseCount;
+    ++s.valid;
+  }
+  return s;
+}
+
+// 从写入位置之后的块 (最旧) 开始, 找下一个块头有效且序号更大的块
+bool FlashLogCursor::openBlock() {
+  while (visited < log->nBlocks) {
+    uint32_t b = (log->head + 1 + visited) % log->nBlocks;
+    ++visited;
+    FlashLog::BlockHeader h;
+    if (!log->readHeader(b, h) || h.seq <= seq) continue;
+    block = b;
+    seq = h.seq;
+    offset = sizeof(FlashLog::BlockHeader);
+    return true;
+  }
+  return false;
+}
+
+bool FlashLogCursor::next(uint8_t &type, uint8_t *buf, uint16_t &len, uint32_t *blockSeq) {
+  if (!log) return false;
+  for (;;) {
+    if (!inBlock) {
+      inBlock = openBlock();
+      if (!inBlock) return false;
+    }
+    inBlock = false; // 下面任何一步失败都转到下一块
+    size_t base = (size_t)block * FlashLog::BLOCK_BYTES;
+    FlashLog::RecordHeader r;
+    if (offset + FlashLog::RECORD_OVERHEAD > FlashLog::BLOCK_BYTES) continue;
+    if (esp_partition_read(log->part, base + offset, &r, sizeof(r)) != ESP_OK) continue;
+    if (r.len > FlashLog::MAX_PAYLOAD || r.check != (uint8_t)~r.type || r.type == 0 || r.type == 0xFF) continue;
+    if (offset + FlashLog::RECORD_OVERHEAD + r.len > FlashLog::BLOCK_BYTES) continue;
+    uint32_t crc;
+    if (esp_partition_read(log->part, base + offset + sizeof(r), buf, r.len) != ESP_OK ||
+        esp_partition_read(log->part, base + offset + sizeof(r) + r.len, &crc, sizeof(crc)) != ESP_OK) {
+      continue;
+    }
+    uint32_t expect = bsecCfg::crc32((const uint8_t *)&r, sizeof(r));
+    expect = bsecCfg::crc32(buf, r.len, expect);
+    if (crc != expect) continue;
+    offset += FlashLog::RECORD_OVERHEAD + r.len;
+    inBlock = true;
+    type = r.type;
+    len = r.len;
+    if (blockSeq) *blockSeq = seq;
+    return true;
+  }
+}
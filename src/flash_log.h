@@ -0,0 +1,108 @@
+#pragma once
+// 断电安全的追加式日志: 样本逐条写入专用 flash 分区 "samplelog" (partitions.csv), 重启/断电后保留。
+// - 分区按 4 KB 扇区分块, 每块以块头开始: magic、块序号 (单调递增) 与该扇区的擦除次数, 块头自带 CRC;
+// - 记录 = [长度][类型][~类型] 负载 [CRC-32], 一次 esp_partition_write() 写完; 读取时遇到擦除态 (0xFF) 或
+//   校验失败即视为该块结束, 断电时写了一半的记录与块头都不会被当成数据;
+// - 块按环形顺序分配, 写满后擦除最旧的块, 各扇区轮流擦除 (磨损均衡), 擦除次数随块头保存;
+// - 启动恢复只读各块的块头 (每块 16 字节): 序号最大的块即写入位置, 之后总是另起新块, 不在可能写坏的块上续写,
+//   每次启动最多浪费一块的余量。
+// 只由 loop() 访问 (与 NVS 相同: 写入/擦除期间 flash cache 暂停, 采集任务最多停顿一次扇区擦除的时间)。
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "sensor_values.h"
+
+// 记录类型
+enum : uint8_t { LOG_SAMPLE = 1 };
+
+// LOG_SAMPLE 的负载: STAT_FIELDS 各通道 (fields 为写入时的通道数, 表变化后旧记录仍可识别)
+struct LogSample {
+  int64_t timestampMs;      // BSEC 时间戳 (每次启动从 0 开始)
+  uint32_t epochSec;        // 墙上时间, 0 = RTC 未设置
+  uint8_t sensor;
+  uint8_t iaqAccuracy;
+  uint8_t fields;
+  uint8_t reserved;
+  float v[STAT_FIELD_COUNT];
+};
+
+class FlashLog;
+
+// 从最旧的记录开始按写入顺序遍历
+class FlashLogCursor {
+public:
+  // buf 至少 FlashLog::MAX_PAYLOAD 字节; 返回 false 表示已读完
+  bool next(uint8_t &type, uint8_t *buf, uint16_t &len, uint32_t *blockSeq = nullptr);
+
+private:
+  friend class FlashLog;
+  bool openBlock();
+
+  const FlashLog *log = nullptr;
+  uint32_t visited = 0;     // 已检查的块数 (环形, 从写入位置之后的块开始)
+  uint32_t block = 0;
+  uint32_t seq = 0;         // 当前块的序号; 之后的块必须更大
+  uint32_t offset = 0;      // 块内下一条记录的位置
+  bool inBlock = false;
+};
+
+// 分区的块头统计 (`log` 命令), 需要重新读一遍所有块头
+struct FlashLogStats {
+  uint32_t blocks = 0;      // 分区块数
+  uint32_t valid = 0;       // 块头有效的块
+  uint32_t oldestSeq = 0, newestSeq = 0;
+  uint32_t minErase = 0, maxErase = 0; // 有效块的擦除次数
+};
+
+class FlashLog {
+public:
+  // 查找分区并从块头恢复写入位置; 没有该分区或分区太小时返回 false
+  bool begin(const char *label);
+  bool active() const { return part != nullptr; }
+
+  // 追加一条记录 (type 1..254, len <= MAX_PAYLOAD); 写入失败返回 false, 下一条另起新块
+  bool append(uint8_t type, const void *data, uint16_t len);
+  FlashLogCursor read() const;
+  FlashLogStats stats() const;
+
+  uint32_t blockCount() const { return nBlocks; }
+  uint32_t headSeq() const { return seq; }
+  uint32_t recordsWritten() const { return records; }
+  uint64_t bytesWritten() const { return bytes; }
+  uint32_t erases() const { return erased; }
+  uint32_t errors() const { return failures; }
+  uint32_t recoveryUs() const { return scanUs; }
+
+  static const uint32_t BLOCK_BYTES = SPI_FLASH_SEC_SIZE;
+  static const uint16_t MAX_PAYLOAD = 256;
+
+private:
+  friend class FlashLogCursor;
+
+  struct BlockHeader {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t eraseCount;  // 含本次在内该扇区被擦除的次数
+    uint32_t crc;         // 前 12 字节的 CRC-32
+  };
+  struct RecordHeader {
+    uint16_t len;         // 负载字节数; 0xFFFF = 擦除态, 块内没有更多记录
+    uint8_t type;
+    uint8_t check;        // ~type
+  };
+  static const uint32_t MAGIC = 0x31474C53; // "SLG1"
+  static const uint32_t RECORD_OVERHEAD = sizeof(RecordHeader) + sizeof(uint32_t);
+
+  bool readHeader(uint32_t b, BlockHeader &h) const;
+  bool openNext();
+
+  const esp_partition_t *part = nullptr;
+  uint32_t nBlocks = 0;
+  uint32_t head = 0;        // 正在写的块 (或最近一次打开的块)
+  uint32_t seq = 0;         // 最大的块序号, 0 = 空分区
+  uint32_t maxErase = 0;
+  uint32_t offset = 0;      // 当前块内下一条记录的位置
+  bool open = false;
+  uint32_t records = 0, erased = 0, failures = 0;
+  uint64_t bytes = 0;
+  uint32_t scanUs = 0;
+};
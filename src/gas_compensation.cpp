@@ -0,0 +1,104 @@
+#include "gas_compensation.h"
+
+static const float REF_T = 25.0f;
+static const float REF_H = 50.0f;
+static const float T_SCALE = 5.0f;    // 回归量缩放到 ~1, 协方差各方向量级相近
+static const float H_SCALE = 10.0f;
+static const float TAU_MS = 24.0f * 3600.0f * 1000.0f;  // 遗忘时间常数
+static const float P_INIT = 1.0f;     // 初始协方差: 系数先验为 0, 每 10%RH/5°C 约 ±1 (ln 单位)
+static const float P_RESTORED = 0.05f; // 从快照恢复的系数更可信
+static const float P_TRACE_MAX = 10.0f;
+static const float LEARNED_VAR = 0.5f; // c1/c2 方差之和低于此值视为已学好
+static const float GATE = -0.15f;     // ln(R) 残差低于此值 (阻值比预测低约 14%) 视为 VOC 事件; 再放宽一个预测标准差
+
+void GasCompensation::regressors(float tempC, float humidity, float phi[GAS_COMP_PARAMS]) {
+  phi[0] = 1.0f;
+  phi[1] = (humidity - REF_H) / H_SCALE;
+  phi[2] = (tempC - REF_T) / T_SCALE;
+}
+
+float GasCompensation::compensate(float gas_kOhm, float tempC, float humidity) const {
+  if (isnan(gas_kOhm) || isnan(tempC) || isnan(humidity)) return gas_kOhm;
+  float phi[GAS_COMP_PARAMS];
+  regressors(tempC, humidity, phi);
+  return gas_kOhm * expf(-(theta[1] * phi[1] + theta[2] * phi[2]));
+}
+
+bool GasCompensation::update(int64_t tsMs, float gas_kOhm, float tempC, float humidity) {
+  if (isnan(gas_kOhm) || gas_kOhm <= 0 || isnan(tempC) || isnan(humidity)) return false;
+  float phi[GAS_COMP_PARAMS];
+  regressors(tempC, humidity, phi);
+  float y = logf(gas_kOhm);
+  if (!seeded) {
+    theta[0] = y - theta[1] * phi[1] - theta[2] * phi[2];
+    seeded = true;
+    lastTsMs = tsMs;
+    return true;
+  }
+
+  float pred = 0.0f;
+  for (uint8_t i = 0; i < GAS_COMP_PARAMS; ++i) pred += theta[i] * phi[i];
+  float e = y - pred;
+  int64_t dtMs = tsMs > lastTsMs ? tsMs - lastTsMs : 0;
+  lastTsMs = tsMs;
+
+  float Pphi[GAS_COMP_PARAMS];
+  float spread = 0.0f;  // phi^T P phi: 模型在该温湿度下的不确定度, 刚开始学习时很大, 门限随之放宽
+  for (uint8_t i = 0; i < GAS_COMP_PARAMS; ++i) {
+    Pphi[i] = 0.0f;
+    for (uint8_t j = 0; j < GAS_COMP_PARAMS; ++j) Pphi[i] += P[i][j] * phi[j];
+    spread += phi[i] * Pphi[i];
+  }
+  if (e < GATE - sqrtf(spread)) {
+    ++nRejected;
+    return false;
+  }
+  float trace = 0.0f;
+  for (uint8_t i = 0; i < GAS_COMP_PARAMS; ++i) trace += P[i][i];
+  // lambda = exp(-dt/TAU); 协方差已经够大 (温湿度缺乏变化) 时不再遗忘
+  float lambda = trace < P_TRACE_MAX ? expf(-(float)dtMs / TAU_MS) : 1.0f;
+  float den = lambda + spread;
+
+  for (uint8_t i = 0; i < GAS_COMP_PARAMS; ++i) theta[i] += Pphi[i] / den * e;
+  // P = (P - Pphi Pphi^T / den) / lambda, 保持对称
+  for (uint8_t i = 0; i < GAS_COMP_PARAMS; ++i) {
+    for (uint8_t j = i; j < GAS_COMP_PARAMS; ++j) {
+      float v = (P[i][j] - Pphi[i] * Pphi[j] / den) / lambda;
+      P[i][j] = P[j][i] = v;
+    }
+  }
+  ++nUpdates;
+  return true;
+}
+
+bool GasCompensation::learned() const { return P[1][1] + P[2][2] < LEARNED_VAR; }
+
+float GasCompensation::humidityPctPerRh() const { return (expf(theta[1] / H_SCALE) - 1.0f) * 100.0f; }
+float GasCompensation::tempPctPerC() const { return (expf(theta[2] / T_SCALE) - 1.0f) * 100.0f; }
+
+void GasCompensation::save(float coeffs[GAS_COMP_PARAMS]) const {
+  for (uint8_t i = 0; i < GAS_COMP_PARAMS; ++i) coeffs[i] = theta[i];
+}
+
+void GasCompensation::restore(const float coeffs[GAS_COMP_PARAMS]) {
+  clear();
+  if (isnan(coeffs[1]) || isnan(coeffs[2])) return;
+  // c0 对应上次运行的漂移水平, 由首个样本重新初始化; 只沿用温湿度系数
+  theta[1] = coeffs[1];
+  theta[2] = coeffs[2];
+  resetCovariance(P_RESTORED);
+}
+
+void GasCompensation::clear() {
+  for (uint8_t i = 0; i < GAS_COMP_PARAMS; ++i) theta[i] = 0.0f;
+  resetCovariance(P_INIT);
+  seeded = false;
+  lastTsMs = -1;
+  nUpdates = nRejected = 0;
+}
+
+void GasCompensation::resetCovariance(float p) {
+  for (uint8_t i = 0; i < GAS_COMP_PARAMS; ++i) {
+    for (uint8_t j = 0; j < GAS_COMP_PARAMS; ++j) P[i][j] = i == j ? p : 0.0f;
+  }
+}
@@ -0,0 +1,43 @@
+#pragma once
+// 气体阻值的温湿度补偿: MOX 阻值随湿度/温度指数变化, HVAC 启停时简易 VOC 指数会跟着摆动。
+// 模型 ln(R) = c0 + c1 * (H - 50) / 10 + c2 * (T - 25) / 5, 以带遗忘因子的递推最小二乘 (RLS) 在线拟合:
+// 每个样本 O(1) (3x3 协方差), 不保存历史。补偿值 = 把阻值换算到参考条件 25°C / 50%RH, 基线与指数都用它。
+// - 只用洁净空气样本更新: 阻值比模型预测低 GATE 以上视为 VOC 事件, 不参与拟合 (否则事件会被"解释"成温湿度效应);
+// - 遗忘按时间计 (TAU = 1 天), 与采样率无关; 协方差迹超过上限时暂停遗忘, 温湿度长时间不变也不会发散;
+// - c0 随漂移变化, 不影响补偿值; c1/c2 随快照保存, 重启后不必重新学习。
+#include <Arduino.h>
+
+static const uint8_t GAS_COMP_PARAMS = 3;
+
+class GasCompensation {
+public:
+  GasCompensation() { clear(); }
+
+  // 换算到参考温湿度的阻值; 温湿度缺失时原样返回
+  float compensate(float gas_kOhm, float tempC, float humidity) const;
+  // 用一个样本更新模型 (调用方保证传感器已稳定); 被判为 VOC 事件而跳过时返回 false
+  bool update(int64_t tsMs, float gas_kOhm, float tempC, float humidity);
+
+  // 每 1%RH / 1°C 阻值变化的百分比
+  float humidityPctPerRh() const;
+  float tempPctPerC() const;
+  uint32_t updates() const { return nUpdates; }
+  uint32_t rejected() const { return nRejected; }
+  // 温湿度系数已足够确定 (冷启动约 1.5 小时的温湿度变化, 从快照恢复时立即满足), 补偿值可用于变点检测
+  bool learned() const;
+
+  void save(float coeffs[GAS_COMP_PARAMS]) const;
+  void restore(const float coeffs[GAS_COMP_PARAMS]);
+  void clear();
+
+private:
+  static void regressors(float tempC, float humidity, float phi[GAS_COMP_PARAMS]);
+  void resetCovariance(float p);
+
+  float theta[GAS_COMP_PARAMS];
+  float P[GAS_COMP_PARAMS][GAS_COMP_PARAMS];
+  bool seeded = false;     // c0 已由首个样本初始化
+  int64_t lastTsMs = -1;
+  uint32_t nUpdates = 0;
+  uint32_t nRejected = 0;
+};
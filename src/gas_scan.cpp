@@ -0,0 +1,159 @@
+#include "gas_scan.h"
+
+const HeaterProfile DEFAULT_HEATER_PROFILE = {
+  {320, 100, 100, 100, 200, 200, 200, 320, 320, 320},
+  {5, 2, 10, 30, 5, 5, 5, 5, 5, 5},
+  10,
+  140,
+};
+
+static const uint16_t HEATER_MIN_C = 100;   // 低于此温度气体测量无效
+static const uint16_t HEATER_MAX_C = 400;   // BME688 加热器上限
+
+bool parseHeaterProfile(const char *text, HeaterProfile &p) {
+  HeaterProfile next = p;
+  next.len = 0;
+  const char *s = text;
+  while (*s) {
+    if (next.len == SCAN_MAX_STEPS) return false;
+    char *end;
+    unsigned long temp = strtoul(s, &end, 10);
+    if (end == s || *end != 'x') return false;
+    s = end + 1;
+    unsigned long mul = strtoul(s, &end, 10);
+    if (end == s || (*end != ',' && *end != '\0')) return false;
+    if (temp < HEATER_MIN_C || temp > HEATER_MAX_C || mul < 1 || mul > 255) return false;
+    next.tempC[next.len] = (uint16_t)temp;
+    next.mul[next.len] = (uint16_t)mul;
+    ++next.len;
+    s = *end ? end + 1 : end;
+  }
+  if (next.len == 0) return false;
+  p = next;
+  return true;
+}
+
+bool GasScanner::start(Bme68x &d, uint8_t sensor, const HeaterProfile &p, int64_t nowUs) {
+  stop();
+  prof = p;
+  d.setTPH(BME68X_OS_1X, BME68X_OS_1X, BME68X_OS_1X);
+  d.setFilter(BME68X_FILTER_OFF);
+  // 与 Bosch 并行模式示例相同: 共享加热时间 = 时间基 - TPH 测量时间
+  uint32_t measUs = d.getMeasDur(BME68X_PARALLEL_MODE);
+  uint16_t minBaseMs = (uint16_t)(measUs / 1000 + 1);
+  if (prof.baseMs < minBaseMs) prof.baseMs = minBaseMs;
+  uint16_t sharedMs = (uint16_t)(prof.baseMs - measUs / 1000);
+  d.setHeaterProf(prof.tempC, prof.mul, sharedMs, prof.len);
+  d.setOpMode(BME68X_PARALLEL_MODE);
+  if (d.checkStatus() == BME68X_ERROR) {
+    d.setOpMode(BME68X_SLEEP_MODE);
+    return false;
+  }
+
+  int64_t baseUs = measUs + sharedMs * 1000LL;
+  cycleUs = 0;
+  for (uint8_t i = 0; i < prof.len; ++i) {
+    stepUs[i] = prof.mul[i] * baseUs;
+    cycleUs += stepUs[i];
+  }
+  dev = &d;
+  sensorIdx = sensor;
+  lastEndUs = nowUs;
+  expected = 0;
+  dueUs = nowUs + stepUs[0];
+  waited = false;
+  haveMeas = false;
+  inCycle = false;
+  vectors = incomplete = lostFields = unstable = 0;
+  return true;
+}
+
+void GasScanner::stop() {
+  if (!dev) return;
+  dev->setOpMode(BME68X_SLEEP_MODE);
+  dev = nullptr;
+}
+
+bool GasScanner::poll(int64_t nowUs, GasVector &out) {
+  if (!dev || nowUs < dueUs) return false;
+  if (dev->fetchData() == 0) {
+    waited = true;
+    dueUs = nowUs + POLL_US;
+    return false;
+  }
+
+  bool done = false;
+  uint8_t left;
+  do {
+    bme68xData f;
+    left = dev->getData(f);
+    if (!(f.status & BME68X_NEW_DATA_MSK) || f.gas_index >= prof.len) continue;
+
+    // meas_index 不连续: 中间的字段已被覆盖, 推算时刻顺延这些步, 当前向量作废
+    uint8_t skipped = haveMeas ? (uint8_t)(f.meas_index - lastMeas - 1) : 0;
+    lastMeas = f.meas_index;
+    haveMeas = true;
+    lostFields += skipped;
+    for (uint8_t k = 0; k < skipped; ++k) lastEndUs += stepUs[(expected + k) % prof.len];
+    lastEndUs += stepUs[f.gas_index];
+    if (skipped) inCycle = false;
+
+    uint8_t g = f.gas_index;
+    if (g == 0) {
+      cur = GasVector{};
+      cur.sensor = sensorIdx;
+      cur.len = prof.len;
+      tphCount = 0;
+      inCycle = true;
+    }
+    cur.gas_kOhm[g] = f.gas_resistance / 1000.0f;
+    if ((f.status & (BME68X_GASM_VALID_MSK | BME68X_HEAT_STAB_MSK)) == (BME68X_GASM_VALID_MSK | BME68X_HEAT_STAB_MSK)) {
+      cur.stableMask |= 1u << g;
+    } else {
+      ++unstable;
+    }
+    cur.temperature += f.temperature;
+    cur.humidity += f.humidity;
+    cur.pressure_hPa += f.pressure / 100.0f;
+    ++tphCount;
+    expected = (g + 1) % prof.len;
+
+    if (g != prof.len - 1) continue;
+    if (!inCycle) {
+      ++incomplete;
+      continue;
+    }
+    inCycle = false;
+    cur.temperature /= tphCount;
+    cur.humidity /= tphCount;
+    cur.pressure_hPa /= tphCount;
+    cur.timestampMs = nowUs / 1000;
+    cur.cycle = vectors++;
+    out = cur;
+    done = true;
+  } while (left);
+
+  // 字段比推算的晚出现 (传感器时钟偏慢): 以实际读出时刻重新对齐, 之后按曲线推算
+  if (waited) {
+    lastEndUs = nowUs;
+    waited = false;
+  }
+  dueUs = lastEndUs + stepUs[expected];
+  return done;
+}
+
+uint32_t GasScanner::msUntilDue(int64_t nowUs) const {
+  if (!dev) return UINT32_MAX;
+  return dueUs > nowUs ? (uint32_t)((dueUs - nowUs + 999) / 1000) : 0;
+}
+
+void GasScanner::print(const HeaterProfile &configured) const {
+  const HeaterProfile &p = dev ? prof : configured;
+  Serial.printf("=== 加热曲线扫描 (%s) ===\n", dev ? "运行中" : "已停止");
+  Serial.printf("曲线 %u 步, 时间基 %u ms:", p.len, p.baseMs);
+  for (uint8_t i = 0; i < p.len; ++i) Serial.printf(" %ux%u", p.tempC[i], p.mul[i]);
+  Serial.println();
+  if (dev) Serial.printf("传感器 #%u, 每轮 %.2f s\n", sensorIdx, cycleUs / 1e6f);
+  Serial.printf("向量 %u, 缺步作废 %u 轮, 丢失字段 %u, 未稳定步 %u\n", vectors, incomplete, lostFields, unstable);
+  Serial.println("================");
+}
@@ -0,0 +1,76 @@
+#pragma once
+// 并行模式加热曲线扫描 (气味指纹): 绕过 BSEC, 直接让一颗 BME688 工作在并行模式, 按最多 10 步的加热曲线循环加热。
+// 每一步结束时传感器产生一个带 gas_index 的数据字段; 一轮扫描的各步阻值组成一个气体向量, 交给 loop() 以 CSV 输出,
+// 用于采集分类器训练数据或直接喂给分类器。
+// 时序取传感器允许的最短: TPH 只做 1x 过采样且不滤波 (每个时间基里的测量开销最小), 曲线首尾相接连续运行、不重新触发;
+// 采集任务按曲线推算下一个字段的产生时刻休眠, 到点立即读出。传感器只缓存 BME68X_N_MEAS 个字段, 读得太慢会被覆盖 (计入丢失)。
+#include <Arduino.h>
+#include <bme68xLibrary.h>
+
+static const uint8_t SCAN_MAX_STEPS = BME68X_MAX_HEATR_PROF_LEN;
+
+struct HeaterProfile {
+  uint16_t tempC[SCAN_MAX_STEPS];
+  uint16_t mul[SCAN_MAX_STEPS];  // 每步持续的时间基个数
+  uint8_t len;
+  uint16_t baseMs;               // 时间基 = TPH 测量 + 共享加热时间
+};
+
+// Bosch 并行模式示例 / BME AI-Studio 的 HP-354 曲线, 时间基 140 ms, 一轮约 10.8 s
+extern const HeaterProfile DEFAULT_HEATER_PROFILE;
+
+// 解析 "320x5,100x2,..." (温度x倍数, 逗号分隔); 失败返回 false 且不修改 p
+bool parseHeaterProfile(const char *text, HeaterProfile &p);
+
+struct GasVector {
+  uint8_t sensor;
+  uint32_t cycle;
+  int64_t timestampMs;           // 本轮最后一步的读出时刻
+  float temperature;             // 本轮各步平均
+  float humidity;
+  float pressure_hPa;
+  float gas_kOhm[SCAN_MAX_STEPS];
+  uint16_t stableMask;           // 第 i 位: 第 i 步阻值有效且加热已稳定
+  uint8_t len;
+};
+
+class GasScanner {
+public:
+  // 采集任务调用: 配置加热曲线并进入并行模式, 失败时传感器回到 sleep
+  bool start(Bme68x &dev, uint8_t sensor, const HeaterProfile &p, int64_t nowUs);
+  void stop();
+  bool active() const { return dev != nullptr; }
+  uint8_t sensor() const { return sensorIdx; }
+  uint32_t cycleMs() const { return (uint32_t)(cycleUs / 1000); }
+
+  // 采集任务调用: 到期时读出已产生的字段; 完成一轮时写入 out 并返回 true
+  bool poll(int64_t nowUs, GasVector &out);
+  // 距下一个字段产生还有多少毫秒
+  uint32_t msUntilDue(int64_t nowUs) const;
+
+  // 未运行时打印 configured (下一次 start 将使用的曲线)
+  void print(const HeaterProfile &configured) const;
+
+private:
+  static const uint32_t POLL_US = 2000;  // 字段比推算的晚出现时的轮询间隔
+
+  Bme68x *dev = nullptr;
+  uint8_t sensorIdx = 0;
+  HeaterProfile prof{};
+  int64_t stepUs[SCAN_MAX_STEPS] = {};
+  int64_t cycleUs = 0;
+  int64_t lastEndUs = 0;     // 上一个字段的 (推算) 产生时刻
+  int64_t dueUs = 0;         // 下一次读取时刻
+  bool waited = false;       // 本字段到期时尚未产生, 正在轮询
+  uint8_t expected = 0;      // 下一个应到的 gas_index
+  uint8_t lastMeas = 0;
+  bool haveMeas = false;
+  bool inCycle = false;      // 当前向量从第 0 步开始且没有缺步
+  GasVector cur{};
+  uint8_t tphCount = 0;
+
+  uint32_t vectors = 0;      // 完整输出的向量
+  uint32_t incomplete = 0;   // 因缺步作废的轮次
+  uint32_t lostFields = 0;   // 被传感器覆盖、没来得及读出的字段
+  uint32_t unstable = 0;     // 加热未稳定或阻值无效的步
+};
@@ -0,0 +1,95 @@
+#include "job_table.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+
+uint64_t monotonicMs() {
+  return (uint64_t)esp_timer_get_time() / 1000ULL;
+}
+
+int8_t JobTable::add(const char *name, uint32_t periodMs, JobFn fn, uint32_t firstDelayMs) {
+  for (int8_t id = 0; id < (int8_t)MAX_JOBS; ++id) {
+    Job &j = jobs[id];
+    if (j.active) continue;
+    j = Job{};
+    j.name = name;
+    j.fn = fn;
+    j.periodMs = periodMs;
+    j.dueMs = monotonicMs() + firstDelayMs;
+    j.active = true;
+    j.lateMinMs = UINT32_MAX;
+    return id;
+  }
+  return -1;
+}
+
+void JobTable::cancel(int8_t id) {
+  if (id < 0 || id >= (int8_t)MAX_JOBS) return;
+  jobs[id].active = false;
+}
+
+void JobTable::reschedule(int8_t id, uint32_t delayMs) {
+  if (id < 0 || id >= (int8_t)MAX_JOBS || !jobs[id].active) return;
+  jobs[id].dueMs = monotonicMs() + delayMs;
+}
+
+int8_t JobTable::earliest() const {
+  int8_t best = -1;
+  for (int8_t i = 0; i < (int8_t)MAX_JOBS; ++i) {
+    if (jobs[i].active && (best < 0 || jobs[i].dueMs < jobs[best].dueMs)) best = i;
+  }
+  return best;
+}
+
+void JobTable::poll(uint64_t nowMs) {
+  // 每执行一个任务重新找最早的: 回调可能增删或改期任务
+  for (int8_t id = earliest(); id >= 0 && jobs[id].dueMs <= nowMs; id = earliest()) {
+    Job &j = jobs[id];
+    uint32_t late = (uint32_t)(nowMs - j.dueMs);
+    ++j.runs;
+    j.lateSumMs += late;
+    if (late < j.lateMinMs) j.lateMinMs = late;
+    if (late > j.lateMaxMs) j.lateMaxMs = late;
+    if (j.periodMs) {
+      // 按计划时刻顺延; 错过的周期直接跳过
+      do {
+        j.dueMs += j.periodMs;
+      } while (j.dueMs <= nowMs);
+    } else {
+      j.active = false;
+    }
+    j.fn();
+  }
+}
+
+uint32_t JobTable::msUntilNext(uint64_t nowMs) const {
+  int8_t id = earliest();
+  if (id < 0) return UINT32_MAX;
+  if (jobs[id].dueMs <= nowMs) return 0;
+  uint64_t d = jobs[id].dueMs - nowMs;
+  return d > UINT32_MAX ? UINT32_MAX : (uint32_t)d;
+}
+
+void JobTable::printStats() const {
+  Serial.println("=== 定时任务 (触发延迟 ms) ===");
+  Serial.printf("%-12s %10s %8s %6s %6s %6s\n", "任务", "周期ms", "次数", "最小", "平均", "最大");
+  for (uint8_t i = 0; i < MAX_JOBS; ++i) {
+    const Job &j = jobs[i];
+    if (!j.name) continue;
+    if (j.runs == 0) {
+      Serial.printf("%-12s %10u %8u %6s %6s %6s\n", j.name, j.periodMs, 0u, "-", "-", "-");
+      continue;
+    }
+    Serial.printf("%-12s %10u %8u %6u %6u %6u\n", j.name, j.periodMs, j.runs, j.lateMinMs,
+                  (uint32_t)(j.lateSumMs / j.runs), j.lateMaxMs);
+  }
+  Serial.println("==============================");
+}
+
+void JobTable::resetStats() {
+  for (uint8_t i = 0; i < MAX_JOBS; ++i) {
+    jobs[i].runs = 0;
+    jobs[i].lateSumMs = 0;
+    jobs[i].lateMinMs = UINT32_MAX;
+    jobs[i].lateMaxMs = 0;
+  }
+}
@@ -0,0 +1,47 @@
+#pragma once
+// 周期任务调度: 固定大小的任务表 (最多 16 项), 时间基准为 64 位单调毫秒 (esp_timer_get_time),
+// 不受 millis() 49.7 天回绕影响。poll() 与 msUntilNext() 线性扫描任务表: 任务只有几个、周期以秒计,
+// 扫描十几项的开销远小于一次唤醒, 不需要时间轮一类的桶结构。
+// 周期任务按计划时刻顺延, 不累积漂移, 并记录每个任务的触发延迟 (实际执行时刻 - 计划时刻)。
+#include <stdint.h>
+
+uint64_t monotonicMs();
+
+class JobTable {
+public:
+  typedef void (*JobFn)();
+  static const uint8_t MAX_JOBS = 16;
+
+  // periodMs = 0 表示一次性任务; firstDelayMs 为首次触发延迟。返回任务 id, 失败返回 -1
+  int8_t add(const char *name, uint32_t periodMs, JobFn fn, uint32_t firstDelayMs);
+  void cancel(int8_t id);
+  // 把任务改为 delayMs 后触发 (周期任务此后按新时刻继续)
+  void reschedule(int8_t id, uint32_t delayMs);
+
+  // 按计划时刻先后运行所有到期任务
+  void poll(uint64_t nowMs);
+  // 距最早到期任务的毫秒数; 没有任务时返回 UINT32_MAX
+  uint32_t msUntilNext(uint64_t nowMs) const;
+
+  void printStats() const;
+  void resetStats();
+
+private:
+  struct Job {
+    const char *name;
+    JobFn fn;
+    uint32_t periodMs;
+    uint64_t dueMs;       // 计划触发时刻
+    bool active;
+    // 触发延迟统计
+    uint32_t runs;
+    uint32_t lateMinMs;
+    uint32_t lateMaxMs;
+    uint64_t lateSumMs;
+  };
+
+  // 计划时刻最早的任务, 没有任务时返回 -1
+  int8_t earliest() const;
+
+  Job jobs[MAX_JOBS]{};
+};
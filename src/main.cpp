@@ -1,33 +1,223 @@
 #include <M5Unified.h>
 #include <Wire.h>
-#include <bsec2.h>  // BSEC2 library (v2.x API)
+#include "bsec_backend.h"  // BSEC2 library (v2.x API) 或 raw_bsec.h
 #include <Preferences.h>
+#include "recorder.h"
+#include "stage_timer.h"
+#include "spsc_ring.h"
+#include "bsec_pacer.h"
+#include "job_table.h"
+#include "sensor_values.h"
+#include "bsec_consumers.h"
+#include "sample_mode.h"
+#include "rate_controller.h"
+#include "sensor_array.h"
+#include "gas_scan.h"
+#include "fast_tph.h"
+#include "rolling_extrema.h"
+#include "voc_baseline.h"
+#include "gas_compensation.h"
+#include "change_detector.h"
+#include "stats_rollup.h"
+#include "sample_history.h"
+#include "flash_log.h"
+#if defined(USE_BSEC2)
+#include "bsec_config.h"
+#endif
+#include <esp_timer.h>
+#include <atomic>
+#include <new>
+#if defined(HOST_BUILD)
+#include <HostHal.h>
+#else
+#include <LittleFS.h>
+#include <SD.h>
+#include <SPI.h>
+#endif
 
 // Sea level pressure (hPa) for altitude calculation - can calibrate later
 static float gSeaLevelPressure = 1013.25f;
 
-// BSEC2 objects
-Bsec2 envSensor;
+// BSEC2 objects: 每个传感器一个 Bsec2 实例, 见 sensor_array.h
+uint8_t currentSensor = 0;                // 正在 run() 的传感器, BSEC 回调据此写入对应槽位
+SampleMode sampleMode = MODE_LP;          // 当前采样模式, 只在采集任务中修改
+SampleModeStats sampleModeStats;
+static_assert(SampleModeStats::SLOTS >= MAX_SENSORS, "SampleModeStats 的槽位少于传感器上限");
+RateController rateController;            // 自适应采样率 (loop() 数据管线中运行, 默认关闭)
+int8_t rateConsumer = -1;
+GasScanner gasScanner;                    // 并行模式加热曲线扫描 (采集任务独占)
+HeaterProfile scanProfile = DEFAULT_HEATER_PROFILE; // 下一次扫描使用的曲线 (loop() 在扫描停止时修改)
+char scanLabel[24] = "";                  // 训练数据标签, 写入每行 CSV (loop() 独占)
+FastTph fastTph;                          // 高速温湿压 (采集任务独占)
+bool fastLog = false;                     // 高速样本逐条以 CSV 输出 (loop() 独占)
 
-Preferences prefs;
-const char *PREF_NAMESPACE = "bsec2";
-const char *PREF_KEY_STATE = "state";
+// NVS: 每个调用点使用自己的局部 Preferences (两个任务都会访问 NVS, 共用一个对象时 begin()/end() 会互相打断)
+const char *PREF_NAMESPACE = "bsec2";     // 库默认配置的状态与配置选择; 自定义配置的状态在 "bsec2_<crc>" 下
+std::atomic<uint32_t> bsecConfigCrc{0};   // 当前配置的 CRC, 0 = 库默认配置; 决定状态保存在哪个命名空间
+#if defined(USE_BSEC2)
+const char *BACKEND_NAME = "BSEC2";
+#define CONFIG_COMMANDS "config, config <名称>|install <名称>|remove <名称>, "
+char bsecConfigName[bsecCfg::kNameLen] = "default"; // 当前 BSEC 配置 (采集任务独占)
+bool bsecConfigFailed = false;            // 最近一次 initBsec2() 中 BSEC 拒绝了所选配置
+#else
+const char *BACKEND_NAME = "bme68x 直驱";  // 轻量构建: 无 IAQ/状态/配置, 见 raw_bsec.h
+#define CONFIG_COMMANDS ""
+#endif
 
-// Timing
-unsigned long lastUpdate = 0;
-const unsigned long UPDATE_INTERVAL_MS = 5000; // auto refresh
-unsigned long lastStateSave = 0;
-const unsigned long STATE_SAVE_INTERVAL_MS = 10UL * 60UL * 1000UL; // 10 minutes
+// Timing: 周期任务都登记在 jobTable 上, 由采集任务驱动 (64 位单调时间, 不受 millis() 回绕影响)
+JobTable jobTable;
+const uint32_t UPDATE_INTERVAL_MS = 5000; // auto refresh
+const uint32_t STATE_SAVE_INTERVAL_MS = 5UL * 60UL * 1000UL; // 精度3后每5min保存
+int8_t jobUiRefresh = -1;
+std::atomic<bool> uiRefreshDue{false};    // "ui" 任务置位, loop() 据此节流界面刷新
+// BSEC 订阅 = 各消费者声明需求的并集
+BsecConsumers bsecConsumers;
+// 数据管线计数: 每个 BSEC 输出都生成一个样本, 被 loop() 消费或因队列满而丢弃
+std::atomic<uint32_t> samplesProduced{0};
+uint32_t samplesProcessed = 0;
+
+// 采集任务 (core 0) 与 loop() (core 1) 之间的交接
+#ifndef HOST_BUILD
+const uint32_t ACQ_TASK_STACK = 8192;
+const UBaseType_t ACQ_TASK_PRIORITY = 5;  // 高于 loop() 的 1
+const BaseType_t ACQ_TASK_CORE = 0;       // loop() 运行在 core 1
+const int SD_SCK_PIN = 36, SD_MISO_PIN = 35, SD_MOSI_PIN = 37, SD_CS_PIN = 4; // CoreS3 TF 卡槽
+#endif
+const uint32_t ACQ_POLL_MS = 2;           // 尚不知道截止时间 (启动/重新初始化后) 时的轮询间隔
+TaskHandle_t acqTaskHandle = nullptr;
+TaskHandle_t loopTaskHandle = nullptr;    // 采集任务发布样本/结果后唤醒 loop() (主机上为空: 单线程, 不需要唤醒)
+const uint32_t LOOP_IDLE_MS = 20;         // loop() 无事可做时最多睡这么久: 按键、触摸与串口命令按此间隔轮询
+uint32_t loopWakeups = 0;                 // `timing`: loop() 迭代次数与忙碌时间 (loop() 独占)
+int64_t loopBusyUs = 0;
+int64_t loopStatsSinceUs = 0;
+enum : uint32_t { ACQ_REQ_REFRESH = 1, ACQ_REQ_I2C_SCAN = 2, ACQ_REQ_REINIT = 4, ACQ_REQ_SAMPLE_MODE = 8, ACQ_REQ_GAS_SCAN = 16,
+                  ACQ_REQ_CONFIG = 32, ACQ_REQ_FAST_TPH = 64, ACQ_REQ_MARK = 128,
+                  // 读写采集任务独占对象的诊断命令, 同样交给采集任务执行
+                  ACQ_REQ_PRINT_SENSORS = 1u << 8, ACQ_REQ_PRINT_SCAN = 1u << 9, ACQ_REQ_PRINT_FAST = 1u << 10,
+                  ACQ_REQ_PRINT_JOBS = 1u << 11, ACQ_REQ_PRINT_SUBS = 1u << 12, ACQ_REQ_PRINT_RATE = 1u << 13,
+                  ACQ_REQ_RESET_TIMING = 1u << 14, ACQ_REQ_RESET_RATE = 1u << 15 };
+// 会重建 Bsec2 实例 (重新 discover) 的请求: loop() 取用上一份传感器表之前推迟执行
+const uint32_t ACQ_REQ_REBUILD = ACQ_REQ_REINIT | ACQ_REQ_CONFIG;
+// 由采集任务记录 (也只由它清零) 的阶段
+const uint32_t ACQ_STAGES = 1u << STAGE_BSEC_RUN | 1u << STAGE_PARSE_OUTPUTS;
+std::atomic<uint8_t> requestedSampleMode{MODE_LP};
+const uint8_t SCAN_OFF = 0xFF;
+std::atomic<uint8_t> requestedScanSensor{SCAN_OFF};
+std::atomic<uint8_t> scanningSensor{SCAN_OFF};  // 正在扫描的传感器, 由采集任务更新
+std::atomic<uint8_t> requestedFastSensor{SCAN_OFF};  // 高速温湿压的传感器, SCAN_OFF = 停止
+std::atomic<uint16_t> requestedFastHz{10};
+#if defined(USE_BSEC2)
+enum ConfigOp : uint8_t { CONFIG_LIST, CONFIG_SELECT, CONFIG_INSTALL, CONFIG_REMOVE };
+char configArg[bsecCfg::kNameLen];        // 要切换到的配置, loop() 准备好配置并写入后才置位 ACQ_REQ_CONFIG
+char savedConfigName[bsecCfg::kNameLen];  // 切换成功后的配置名, 采集任务写入后才置位 configSaveDue, 由 loop() 写入 NVS
+std::atomic<bool> configSaveDue{false};   // 置位期间不接受新的配置操作, savedConfigName 不会被覆盖
+#endif
+std::atomic<bool> sensorsReinitDue{false}; // 采集任务重建了 Bsec2 实例 (BtnC / 切换配置): loop() 取用新的传感器表并重新加载简易 VOC 状态
+bool sensorsRebuilt = false;               // 采集任务: 本次迭代中 initBsec2() 重新 discover 过
+SensorTable pendingSensorTable;            // 采集任务写入后才置位 sensorsReinitDue, 置位期间不再改写
+SensorTable sensorTable;                   // loop() 使用的传感器表 (数量、位置、NVS 键), 不直接读 SensorArray
+std::atomic<uint32_t> acqRequests{0};     // 按键/命令请求, 由采集任务执行 (Wire/BSEC 只在采集任务中访问)
+uint8_t pendingStateBlobs[MAX_SENSORS][BSEC_MAX_STATE_BLOB_SIZE];
+uint32_t pendingStateConfig[MAX_SENSORS];  // 取出状态时的配置 CRC: 切换配置后落盘的旧状态仍写入旧配置的命名空间
+char pendingStateKey[MAX_SENSORS][14];     // 取出状态时的 NVS 键: 重新 discover 后传感器顺序可能已变
+std::atomic<uint16_t> pendingStateMask{0}; // 第 i 位: 传感器 i 的状态已取出, 等待 loop() 落盘
+std::atomic<bool> rebuildPending{false};   // loop() 请求重建实例 (BtnC / 切换配置) 时置位, 采集任务重建完成后清零
+#if defined(USE_BSEC2)
+char pendingConfigName[bsecCfg::kNameLen]; // 随传感器表一起交给 loop() 的当前配置名
+char activeConfigName[bsecCfg::kNameLen];  // loop() 使用的当前配置名 (loop() 独占)
+#endif
+
+// 诊断命令的快照: 采集任务复制其独占对象的状态, loop() 格式化并写到串口, 采集任务不等待 UART
+struct SensorReport {
+  uint8_t count;
+  bool mux;
+  uint32_t periodMs;
+  uint32_t outputs[MAX_SENSORS];
+  uint32_t runUs[MAX_SENSORS];
+  const char *status[MAX_SENSORS];    // 字符串常量
+};
+struct AcqReports {
+  SensorReport sensors;               // ACQ_REQ_PRINT_SENSORS
+  I2cScanResult i2c;                  // ACQ_REQ_I2C_SCAN
+  GasScanner scan;                    // ACQ_REQ_PRINT_SCAN
+  FastTph fast;                       // ACQ_REQ_PRINT_FAST
+  int64_t fastNowUs;
+  JobTable jobs;                      // ACQ_REQ_PRINT_JOBS
+  BsecOutputMask subs;                // ACQ_REQ_PRINT_SUBS: 需求表本身由 loop() 读取, 只复制当前订阅
+  SampleModeStats rate;               // ACQ_REQ_PRINT_RATE
+  uint64_t rateNowMs;
+};
+const uint32_t ACQ_REPORTS = ACQ_REQ_I2C_SCAN | ACQ_REQ_PRINT_SENSORS | ACQ_REQ_PRINT_SCAN | ACQ_REQ_PRINT_FAST |
+                             ACQ_REQ_PRINT_JOBS | ACQ_REQ_PRINT_SUBS | ACQ_REQ_PRINT_RATE;
+AcqReports acqReports;                     // 采集任务写入后才置位 reportsReady 中对应的位, 置位期间不再改写
+std::atomic<uint32_t> reportsReady{0};     // ACQ_REPORTS 中的位: 快照已填好, 等待 loop() 输出
+// 采集任务的日志行 (初始化、订阅、模式切换等提示): 格式化后入队, 由 loop() 写到串口
+struct LogLine {
+  char text[128];
+};
+SpscRing<LogLine, 64> acqLogQueue;
 
 // Forward declarations
 void drawStaticUI();
 struct SensorValues;
 void updateDynamicUI(const SensorValues &vals);
-void i2cScan();
 bool initBsec2();
-void loadState();
+bool applySubscription(uint8_t i);
+void scheduleSensorConfig();
+void applyDueConfigs(int64_t now);
+void setGasScan(uint8_t i);
+void setFastTph(uint8_t i, uint16_t hz);
+void updateRolling(SensorValues &vals);
+void updateSimpleVoc(SensorValues &vals);
+void loadVocBaselines();
+void publishSensorTable();
+void takeSensorTable();
+void reloadVocState();
+void saveVocBaselines();
+void putVocBaseline(Preferences &prefs, uint8_t i);
+void vocKey(uint8_t i, char *key, size_t len);
+int64_t wallClockSec();
+void setRollingWindow(uint8_t f, uint32_t ms);
+void detectChanges(const SensorValues &vals);
+void processEvent(const ChangeEvent &ev);
+void printEvents();
+void updateRollups(const SensorValues &vals);
+RunningStats rollupStats(uint8_t i, uint8_t f, uint8_t level, uint16_t buckets);
+void printRollups();
+void printRollupBuckets(uint8_t level);
+void printHistory();
+void printSensors(const SensorReport &r);
+void acqLog(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+void printAcqLog();
+void printReports();
+void wakeLoop();
+void printLoopDuty();
+void exportHistory(uint32_t minutes);
+void logSample(const SensorValues &vals);
+void printFlashLog();
+void dumpFlashLog();
+#if defined(USE_BSEC2)
+void loadConfigSelection();
+void saveConfigSelection();
+void runConfigOp(ConfigOp op, const char *name);
+void selectConfig(const char *name);
+void requestConfigSelect(const char *name);
+#endif
+bool setSampleMode(SampleMode mode);
+void requestSampleMode(SampleMode mode);
+void registerConsumers();
+void loadState(uint8_t i);
+bool captureState(uint8_t i);
 void saveState();
+void stateNamespace(uint32_t configCrc, char *ns, size_t len);
 float calcAltitude(float pressure_hPa);
+void onBsecOutputs(const bme68xData data, const bsecOutputs outputs, const Bsec2 bsec);
+void pollSerialCommands();
+void handleSerialCommand(const char *cmd);
+void registerJobs();
+#ifndef HOST_BUILD
+void acquisitionTask(void *);
+#endif
 
 // Regions for partial refresh
 struct ValueRegion { int16_t x,y,w,h; };
@@ -41,43 +231,52 @@ ValueRegion regionIndicator{200, 175, 20, 20};
 // Simple flag to know first draw
 bool uiDrawn = false;
 
-struct SensorValues {
-  float temperature{NAN};
-  float humidity{NAN};
-  float pressure_hPa{NAN};
-  float gas_kOhm{NAN};
-  float altitude_m{NAN};
-  float iaq{NAN};
-  uint8_t iaqAccuracy{0};
-  float co2eq{NAN};
-  float vocEq{NAN};
-  uint32_t readMs{0};
-  // 简易 VOC 指数相关
-  float simpleVocIndex{NAN};
-  float gasBaseline_kOhm{NAN};
-  float gasMinWindow_kOhm{NAN};
+SpscRing<SensorValues, 32> sampleQueue;  // 采集任务 -> loop(); 多个传感器可能在同一次迭代中各产生一个样本
+SpscRing<GasVector, 8> vectorQueue;      // 加热曲线扫描的气体向量, 采集任务 -> loop()
+SpscRing<FastTphSample, 32> fastQueue;   // 高速温湿压样本, 采集任务 -> loop()
+uint8_t uiSensor = 0;                     // 界面/串口显示的传感器 (loop() 独占)
+// 简易 VOC 指数: 每个传感器一个自适应基线 (loop() 独占), 与 BSEC 状态一起保存在 NVS 中
+static VocBaseline vocBaselines[MAX_SENSORS];
+static GasCompensation gasComp[MAX_SENSORS]; // 气体阻值的温湿度补偿模型 (RLS)
+static bool vocWarm[MAX_SENSORS];         // 传感器已稳定, 阻值可用于基线
+static bool vocWarmStart[MAX_SENSORS];    // 快照足够新: BSEC 报告稳定前先用保存的基线给出指数
+static float vocSavedMin[MAX_SENSORS], vocSavedMax[MAX_SENSORS]; // 快照中的阻值范围, 热启动时检验读数
+static const int64_t VOC_SNAPSHOT_MAX_AGE_S = 7LL * 24LL * 3600LL; // 超过 7 天的快照丢弃, 重新建立基线
+static const int64_t VOC_WARM_START_MAX_AGE_S = 30LL * 60LL;       // 30 分钟内的快照可从首个样本起直接使用
+static const float VOC_WARM_START_MARGIN = 0.3f;   // 热启动读数允许超出保存范围的比例 (温湿度变化也会改变阻值)
+static const int64_t VALID_EPOCH_S = 1700000000LL; // 早于此 (2023-11) 的系统时间视为 RTC 未设置
+static bool vocProvisional[MAX_SENSORS];  // 基线建立时尚未完成磨合, 磨合完成后重新建立
+// BSEC 稳定/磨合状态不可用时 (轻量构建) 的退路: 启动后 2 分钟视为已稳定
+static const uint32_t BASELINE_DELAY_MS = 2UL * 60UL * 1000UL;
+static const uint32_t VOC_SAVE_INTERVAL_MS = 60UL * 60UL * 1000UL; // 每小时保存一次基线
+std::atomic<bool> vocSaveDue{false};      // "voc" 任务置位, loop() 据此写入 NVS (轻量构建/精度未到 3 时没有状态保存)
+// 滑动窗口最小/最大值: 每个传感器、每个 ROLLING_FIELDS 通道一份 (loop() 独占)
+static const size_t ROLLING_SLOTS = 30;   // 窗口边界精度 = 窗口 / 30
+static RollingExtrema<ROLLING_SLOTS> rolling[MAX_SENSORS][ROLLING_FIELD_COUNT];
+// 变点检测: 每个传感器、每个 EVENT_CHANNELS 通道一个 CUSUM (loop() 独占); 事件经队列交给日志/告警消费者
+static ChangeDetector changeDetectors[MAX_SENSORS][EVENT_CHANNEL_COUNT];
+SpscRing<ChangeEvent, 16> eventQueue;     // 数据管线 -> 事件消费者 (都在 loop() 中, 队列把检测与输出解耦)
+static const uint8_t RECENT_EVENTS = 8;
+static ChangeEvent recentEvents[RECENT_EVENTS]; // 最近的事件, `events` 命令查看
+static uint32_t eventCount = 0;
+// 多分辨率统计: 每个传感器 1 分钟 / 1 小时 / 24 小时三级, 各保留 60 个桶 (1 小时 / 2.5 天 / 2 个月)
+static const uint16_t ROLLUP_BUCKETS = 60;
+typedef StatsRollup<STAT_FIELD_COUNT, ROLLUP_BUCKETS> Rollup;
+struct RollupLevel {
+  const char *name;
+  uint32_t ms;
 };
-// 简易 VOC 指数参数
-static bool baselineEstablished = false;
-static float gasBaseline = NAN;         // 初始基线 (首次稳定阻值)
-static float gasMinWindow = NAN;        // 滑动窗口最小阻值
-static const uint32_t BASELINE_DELAY_MS = 2UL * 60UL * 1000UL; // 启动后 2 分钟再锁定基线
-static const uint32_t WINDOW_UPDATE_INTERVAL_MS = 30UL * 1000UL; // 30 秒更新一次最小值
-static unsigned long lastWindowUpdate = 0;
-
-float computeSimpleVocIndex(float gasCurrent) {
-  // gasCurrent: kOhm
-  if (!baselineEstablished || isnan(gasBaseline) || gasBaseline <= 0) return NAN;
-  // 初始化 window 最小值
-  if (isnan(gasMinWindow)) gasMinWindow = gasCurrent;
-  // 每次更新维护最小值
-  if (gasCurrent < gasMinWindow) gasMinWindow = gasCurrent;
-  // 计算指数 (基于基线下降百分比)
-  float delta = gasBaseline - gasCurrent; // 阻值降低 => VOC 增加
-  float index = (delta / gasBaseline) * 100.0f;
-  if (index < 0) index = 0; // 不允许负值
-  return index;
-}
+static const RollupLevel ROLLUP_LEVELS[] = {{"1m", 60UL * 1000UL}, {"1h", 60UL * 60UL * 1000UL}, {"24h", 24UL * 60UL * 60UL * 1000UL}};
+static const uint8_t ROLLUP_LEVEL_COUNT = sizeof(ROLLUP_LEVELS) / sizeof(ROLLUP_LEVELS[0]);
+// 每个传感器约 25 KB, 在其首个样本到达时分配 (设备上大于 4 KB 的分配落在 PSRAM); loop() 独占
+static Rollup *rollups[MAX_SENSORS];
+// 压缩的逐样本历史 (loop() 独占); 设备上放在 PSRAM, 分配失败时逐次减半
+static const size_t HISTORY_POOL_BYTES = 6UL * 1024UL * 1024UL;
+SampleHistory history;
+// 断电安全的样本日志 (flash 分区 "samplelog", loop() 独占); 重启后保留, PSRAM 历史在重启时丢失
+static const char *SAMPLE_LOG_LABEL = "samplelog";
+static const uint32_t FLASH_ENDURANCE_CYCLES = 100000; // SPI NOR 扇区的典型擦写寿命
+FlashLog flashLog;
 
 const char* classifySimpleVoc(float index) {
   if (isnan(index)) return "建立中";
@@ -95,159 +294,1361 @@ void setup() {
   Wire.begin();
 
   Serial.println("\n=== 启动: M5Stack CoreS3 + ENV Pro (BME688) ===");
+#ifndef HOST_BUILD
+  M5.Rtc.setSystemTimeFromRtc(); // 简易 VOC 快照以墙上时间判断年龄
+#endif
 
   drawStaticUI();
   uiDrawn = true;
 
-  if (!initBsec2()) {
-    Serial.println("BME688 初始化失败 (BSEC2)");
+  // 原始帧录制 (主机: --record FILE; 设备: 编译时定义 RAW_RECORD_PATH, 写入 LittleFS)
+  // BSEC 配置文件放在 LittleFS 或 SD 卡的 /bsec 目录下
+#if defined(HOST_BUILD)
+  if (!host::options().recordPath.empty()) rawRecorder.begin(host::options().recordPath.c_str());
+#else
+  if (LittleFS.begin(true)) {
+#if defined(RAW_RECORD_PATH)
+    rawRecorder.begin(RAW_RECORD_PATH);
+#endif
+  } else {
+    Serial.println("[存储] LittleFS 挂载失败");
+  }
+  // CoreS3 的 TF 卡槽与 LCD 共用 SPI 总线 (CS = GPIO4); 没插卡不影响启动
+  SPI.begin(SD_SCK_PIN, SD_MISO_PIN, SD_MOSI_PIN, SD_CS_PIN);
+  if (!SD.begin(SD_CS_PIN, SPI, 25000000)) Serial.println("[存储] 未检测到 SD 卡");
+#endif
+
+  // 历史与 flash 日志先于消费者登记: 不可用时不订阅它们的输出
+  size_t historyBytes = history.begin(HISTORY_POOL_BYTES);
+  if (historyBytes) {
+    Serial.printf("[历史] 样本历史 %u KB (%u 块)\n", (unsigned)(historyBytes / 1024), history.blockCount());
   } else {
-    Serial.println("✓ BME688 初始化成功 (BSEC2)");
+    Serial.println("[历史] 内存不足, 不保存样本历史");
+  }
+  if (flashLog.begin(SAMPLE_LOG_LABEL)) {
+    Serial.printf("[日志] flash 样本日志 %u 块, 恢复 (读块头) %u us, 从块 #%u 之后继续\n", flashLog.blockCount(),
+                  flashLog.recoveryUs(), flashLog.headSeq());
+  } else {
+    Serial.println("[日志] 没有 samplelog 分区, 样本不落盘");
+  }
+#if defined(USE_BSEC2)
+  bsecConfigs.begin();
+  loadConfigSelection();
+#endif
+  registerConsumers();
+  bool sensorsOk = initBsec2();
+  printAcqLog();
+  if (!sensorsOk) {
+    Serial.printf("BME688 初始化失败 (%s)\n", BACKEND_NAME);
+  } else {
+    Serial.printf("✓ BME688 初始化成功 (%s)\n", BACKEND_NAME);
+  }
+
+  if (sensorsRebuilt) publishSensorTable();
+  takeSensorTable();
+  loadVocBaselines();
+  registerJobs();
+  for (uint8_t f = 0; f < ROLLING_FIELD_COUNT; ++f) setRollingWindow(f, ROLLING_FIELDS[f].windowMs);
+  for (uint8_t i = 0; i < MAX_SENSORS; ++i) {
+    for (uint8_t c = 0; c < EVENT_CHANNEL_COUNT; ++c) {
+      const EventChannel &ec = EVENT_CHANNELS[c];
+      changeDetectors[i][c].configure(ec.direction, ec.k, ec.h, ec.tauMin);
+    }
+  }
+  Serial.printf("[启动] setup() 完成: %lld ms\n", (long long)(esp_timer_get_time() / 1000));
+
+#ifndef HOST_BUILD
+  // 采集放在 core 0 的高优先级任务里; loop() 留在 core 1 负责显示/串口/NVS
+  loopTaskHandle = xTaskGetCurrentTaskHandle(); // setup() 与 loop() 在同一个任务中运行
+  xTaskCreatePinnedToCore(acquisitionTask, "acq", ACQ_TASK_STACK, nullptr, ACQ_TASK_PRIORITY, &acqTaskHandle, ACQ_TASK_CORE);
+#endif
+}
+
+// ---- 采集任务 (core 0): 只做 BSEC 调度与样本生成, 不碰 LCD/串口/文件, 不写 NVS ----
+// 每次 BSEC 产生输出后调用: 生成一份样本交给 loop() 的数据管线 (基线/统计/记录/界面)
+void publishSample(uint8_t i, uint32_t runCycles) {
+  SensorSlot &s = sensors[i];
+  SensorValues vals = s.values;
+  vals.readUs = stageTimers.toUs(runCycles);
+  vals.timestampMs = s.lastOutputTsMs;
+  vals.periodMs = s.periodMs;
+  vals.sensor = i;
+
+  // 压力单位自适应: 若值>5000 认为是 Pa, 否则已是 hPa
+  if (vals.pressure_hPa > 5000.0f) vals.pressure_hPa /= 100.0f; // Pa->hPa
+  vals.altitude_m = calcAltitude(vals.pressure_hPa);
+
+  samplesProduced.fetch_add(1, std::memory_order_relaxed);
+  sampleQueue.push(vals); // 队列满时计入 sampleQueue.dropped()
+  wakeLoop(); // 其余传感器还在测量时 loop() 就可以开始处理
+}
+
+// 采集任务: 有新内容 (样本、请求的结果、日志行、定时任务标志) 交给 loop() 时提前唤醒它
+void wakeLoop() {
+  if (loopTaskHandle) xTaskNotifyGive(loopTaskHandle);
+}
+
+// 采集任务的串口输出: 格式化后入队, 由 loop() 写出; 队列满时丢弃 (计入 acqLogQueue.dropped())
+void acqLog(const char *fmt, ...) {
+  LogLine line;
+  va_list args;
+  va_start(args, fmt);
+  int len = vsnprintf(line.text, sizeof(line.text), fmt, args);
+  va_end(args);
+  if (len >= (int)sizeof(line.text)) line.text[sizeof(line.text) - 2] = '\n'; // 截断的行仍以换行结束
+  acqLogQueue.push(line);
+}
+
+// 定时任务: 通知 loop() 刷新一次界面 (界面只是数据管线中一个被节流的消费者)
+void jobRequestUiRefresh() {
+  uiRefreshDue.store(true, std::memory_order_release);
+}
+
+// 定时任务: 精度达到 3 后把状态 blob 交给 loop() 落盘 (getState 必须在采集任务里调用)
+void jobCaptureState() {
+  for (uint8_t i = 0; i < sensors.count(); ++i) {
+    if (sensors[i].ok && sensors[i].values.iaqAccuracy == 3) captureState(i);
+  }
+}
+
+// 定时任务: 通知 loop() 保存简易 VOC 基线
+void jobSaveVocBaseline() {
+  vocSaveDue.store(true, std::memory_order_release);
+}
+
+// 顺序测量的总耗时超过采样周期时, 后面的传感器必然迟到 (bsecStatus=100); 每个采样模式提示一次
+void checkBusBudget() {
+  static SampleMode warnedMode = MODE_COUNT;
+  uint32_t busyUs = 0;
+  for (uint8_t i = 0; i < sensors.count(); ++i) busyUs += sensors[i].lastRunUs;
+  uint32_t periodMs = samplePeriodMs(sampleMode);
+  if (busyUs / 1000 <= periodMs || warnedMode == sampleMode) return;
+  warnedMode = sampleMode;
+  acqLog("[WARN] %u 个传感器顺序测量需 %u ms, 超过 %s 采样周期 %u ms, 部分测量会迟到\n", sensors.count(),
+         busyUs / 1000, SAMPLE_MODES[sampleMode].name, periodMs);
+}
+
+void runSensor(uint8_t i) {
+  SensorSlot &s = sensors[i];
+  if (!s.ok || (gasScanner.active() && gasScanner.sensor() == i)) return; // 扫描期间 BSEC 不接管该传感器
+  currentSensor = i;
+  uint32_t outputsBefore = s.outputCount;
+  uint32_t t0 = StageTimers::now();
+  bool got = s.bsec.run(); // 到期时调用, 内部决定是否有新输出
+  uint32_t runCycles = stageTimers.end(STAGE_BSEC_RUN, t0);
+  bool produced = s.outputCount != outputsBefore;
+  sampleModeStats.onRun(i, stageTimers.toUs(runCycles), produced);
+  if (produced) {
+    s.lastRunUs = stageTimers.toUs(runCycles);
+    publishSample(i, runCycles);
+    checkBusBudget();
+  }
+  if (!got) {
+    static bool warnedOnce = false;
+    if (!warnedOnce) {
+      acqLog("[WARN] #%u 暂无新数据 (bsecStatus=%d, bmeStatus=%d) 等待稳定...\n", i, s.bsec.status, s.bsec.sensor.status);
+      warnedOnce = true;
+    }
+  }
+}
+
+// 距传感器 i 下一次 BSEC 调用 (或错开的重新订阅) 还有多少毫秒; 未订阅时不限
+uint32_t bsecDueMs(uint8_t i) {
+  SensorSlot &s = sensors[i];
+  uint32_t ms = UINT32_MAX;
+  if (s.configAtMs >= 0) {
+    int64_t now = monotonicMs();
+    ms = s.configAtMs > now ? (uint32_t)(s.configAtMs - now) : 0;
+  }
+  if (s.periodMs) ms = std::min(ms, s.pacer.msUntilDue(s.bsec.getTimeMs()));
+  return ms;
+}
+
+void pollFastTph() {
+  if (!fastTph.active()) return;
+  FastTphSample v;
+  if (fastTph.poll(esp_timer_get_time(), bsecDueMs(fastTph.sensor()), v)) fastQueue.push(v);
+}
+
+// 采集任务: 重新 discover 后把传感器表交给 loop()
+void publishSensorTable() {
+  sensorsRebuilt = false;
+  sensors.snapshot(pendingSensorTable);
+#if defined(USE_BSEC2)
+  snprintf(pendingConfigName, sizeof(pendingConfigName), "%s", bsecConfigName);
+#endif
+  sensorsReinitDue.store(true, std::memory_order_release);
+}
+
+// 采集任务: 为诊断命令复制快照; loop() 尚未输出上一份时沿用上一份
+void fillReports(uint32_t req) {
+  req &= ACQ_REPORTS & ~reportsReady.load(std::memory_order_acquire);
+  if (!req) return;
+  AcqReports &r = acqReports;
+  if (req & ACQ_REQ_I2C_SCAN) sensors.scan(r.i2c);
+  if (req & ACQ_REQ_PRINT_SENSORS) {
+    r.sensors.count = sensors.count();
+    r.sensors.mux = sensors.hasMux();
+    r.sensors.periodMs = samplePeriodMs(sampleMode);
+    for (uint8_t i = 0; i < sensors.count(); ++i) {
+      SensorSlot &s = sensors[i];
+      bool scanning = gasScanner.active() && gasScanner.sensor() == i;
+      r.sensors.outputs[i] = s.outputCount;
+      r.sensors.runUs[i] = s.lastRunUs;
+      r.sensors.status[i] = !s.ok ? "初始化失败" : scanning ? "加热曲线扫描" : s.configAtMs >= 0 ? "待订阅" : s.periodMs ? "运行" : "未订阅";
+    }
+  }
+  if (req & ACQ_REQ_PRINT_SCAN) r.scan = gasScanner;
+  if (req & ACQ_REQ_PRINT_FAST) {
+    r.fast = fastTph;
+    r.fastNowUs = esp_timer_get_time();
+  }
+  if (req & ACQ_REQ_PRINT_JOBS) r.jobs = jobTable;
+  if (req & ACQ_REQ_PRINT_SUBS) r.subs = sensors.count() ? sensors[0].activeMask : 0;
+  if (req & ACQ_REQ_PRINT_RATE) {
+    r.rate = sampleModeStats;
+    r.rateNowMs = monotonicMs();
+  }
+  reportsReady.fetch_or(req, std::memory_order_release);
+}
+
+void acquisitionStep() {
+  uint32_t req = acqRequests.exchange(0, std::memory_order_acq_rel);
+  if ((req & ACQ_REQ_REBUILD) && sensorsReinitDue.load(std::memory_order_acquire)) {
+    acqRequests.fetch_or(req & ACQ_REQ_REBUILD, std::memory_order_acq_rel); // loop() 取用传感器表后唤醒本任务
+    req &= ~ACQ_REQ_REBUILD;
+  }
+  if (req & ACQ_REQ_REFRESH) jobTable.reschedule(jobUiRefresh, 0); // force
+  if (req & ACQ_REQ_REINIT) initBsec2();
+  if (req & ACQ_REQ_SAMPLE_MODE) setSampleMode((SampleMode)requestedSampleMode.load(std::memory_order_acquire));
+  if (req & ACQ_REQ_GAS_SCAN) setGasScan(requestedScanSensor.load(std::memory_order_acquire));
+  if (req & ACQ_REQ_FAST_TPH) setFastTph(requestedFastSensor.load(std::memory_order_acquire), requestedFastHz.load(std::memory_order_acquire));
+  // 录制文件中的人工标记 (`mark` 命令), 与帧使用同一 BSEC 时间基准, 回放时作为事件的真值
+  if ((req & ACQ_REQ_MARK) && sensors.count()) rawRecorder.mark(sensors[0].bsec.getTimeMs() * 1000000LL);
+#if defined(USE_BSEC2)
+  if (req & ACQ_REQ_CONFIG) selectConfig(configArg);
+#endif
+  if (sensorsRebuilt) publishSensorTable();
+  if (req & ACQ_REQ_REBUILD) rebuildPending.store(false, std::memory_order_release); // 之后 loop() 才会改动配置仓库
+  fillReports(req);
+  if (req & ACQ_REQ_RESET_TIMING) {
+    stageTimers.reset(ACQ_STAGES);
+    jobTable.resetStats();
+  }
+  if (req & ACQ_REQ_RESET_RATE) sampleModeStats.reset(monotonicMs());
+  if (bsecConsumers.takeChanged()) scheduleSensorConfig();
+  applyDueConfigs(monotonicMs());
+
+  // 高速温湿压先于 BSEC: 本路径的测量总在 BSEC 截止前读出
+  pollFastTph();
+  // 所有传感器在这里顺序 run(): 同一时刻只有一个在测量, 总线与加热互不重叠
+  for (uint8_t i = 0; i < sensors.count(); ++i) runSensor(i);
+  GasVector vec;
+  if (gasScanner.poll(esp_timer_get_time(), vec)) vectorQueue.push(vec);
+
+  jobTable.poll(monotonicMs());
+  wakeLoop(); // 本次迭代处理的请求、扫描/高速样本、定时任务标志都在此后对 loop() 可见
+}
+
+void registerJobs() {
+  jobUiRefresh = jobTable.add("ui", UPDATE_INTERVAL_MS, jobRequestUiRefresh, UPDATE_INTERVAL_MS);
+  jobTable.add("state", STATE_SAVE_INTERVAL_MS, jobCaptureState, STATE_SAVE_INTERVAL_MS);
+  jobTable.add("voc", VOC_SAVE_INTERVAL_MS, jobSaveVocBaseline, VOC_SAVE_INTERVAL_MS);
+}
+
+// 采集任务每次迭代后的休眠时长: 一直睡到最早到期的传感器、待生效的订阅或定时任务, 期间由按键请求通过任务通知提前唤醒
+TickType_t acquisitionIdleTicks() {
+  int64_t now = monotonicMs();
+  uint32_t waitMs = UINT32_MAX;
+  for (uint8_t i = 0; i < sensors.count(); ++i) {
+    SensorSlot &s = sensors[i];
+    if (s.configAtMs >= 0) waitMs = std::min(waitMs, s.configAtMs > now ? (uint32_t)(s.configAtMs - now) : 0u);
+    if (gasScanner.active() && gasScanner.sensor() == i) continue;
+    if (s.ok && s.periodMs) waitMs = std::min(waitMs, s.pacer.msUntilDue(s.bsec.getTimeMs()));
+  }
+  waitMs = std::min(waitMs, gasScanner.msUntilDue(esp_timer_get_time()));
+  waitMs = std::min(waitMs, fastTph.msUntilDue(esp_timer_get_time()));
+  if (waitMs == 0) waitMs = ACQ_POLL_MS;
+  uint32_t jobMs = jobTable.msUntilNext(now);
+  if (jobMs < waitMs) waitMs = jobMs ? jobMs : 1;
+  return pdMS_TO_TICKS(waitMs);
+}
+
+void requestAcquisition(uint32_t req) {
+  acqRequests.fetch_or(req, std::memory_order_acq_rel);
+  xTaskNotifyGive(acqTaskHandle);
+}
+
+#ifndef HOST_BUILD
+void acquisitionTask(void *) {
+  for (;;) {
+    acquisitionStep();
+    ulTaskNotifyTake(pdTRUE, acquisitionIdleTicks());
+  }
+}
+#endif
+
+// ---- 显示/串口/持久化 (loop(), core 1): 消费采集任务发布的样本 ----
+// 数据管线: 每个样本都经过这里, 后续的统计/记录/告警消费者挂在此处
+void processSample(SensorValues &vals) {
+  // 启动耗时: 上电到第一个样本进入数据管线 (两种构建对比见 README)
+  if (samplesProcessed == 0) Serial.printf("[启动] 首个样本: %lld ms (%s)\n", (long long)(esp_timer_get_time() / 1000), BACKEND_NAME);
+  ++samplesProcessed;
+  updateSimpleVoc(vals);
+  updateRolling(vals);
+  detectChanges(vals);
+  updateRollups(vals);
+  history.append(vals);
+  logSample(vals);
+  SampleMode want = rateController.onSample(vals);
+  if (want != MODE_COUNT) requestSampleMode(want);
+}
+
+// 简易 VOC: 传感器稳定后, 没有基线 (首次启动/快照无效) 时以当前阻值建立, 之后每个样本都推进自适应基线。
+// 稳定与否取 BSEC 的 STABILIZATION_STATUS: 热重启 (状态已恢复) 时比固定延时早, 冷启动时比固定延时晚;
+// 在磨合 (RUN_IN_STATUS) 完成前建立的基线只是临时的, 磨合完成时以当时的阻值重新建立一次
+void updateSimpleVoc(SensorValues &vals) {
+  uint8_t i = vals.sensor;
+  VocBaseline &b = vocBaselines[i];
+  bool haveStatus = !isnan(vals.stabilization);
+  bool stable = haveStatus ? vals.stabilization >= 1.0f : vals.timestampMs >= (int64_t)BASELINE_DELAY_MS;
+  bool runIn = isnan(vals.runIn) || vals.runIn >= 1.0f;
+  // 温湿度取加热补偿后的环境值 (未订阅时退回原始值)
+  float t = isnan(vals.compTemperature) ? vals.temperature : vals.compTemperature;
+  float h = isnan(vals.compHumidity) ? vals.humidity : vals.compHumidity;
+  vals.gasComp_kOhm = gasComp[i].compensate(vals.gas_kOhm, t, h);
+  if (vocWarmStart[i]) {
+    // 热启动: BSEC 报告稳定之前, 只要读数仍在快照的阻值范围附近就沿用保存的基线
+    float lo = vocSavedMin[i] * (1.0f - VOC_WARM_START_MARGIN), hi = vocSavedMax[i] * (1.0f + VOC_WARM_START_MARGIN);
+    if (stable || !(vals.gas_kOhm >= lo && vals.gas_kOhm <= hi)) {
+      vocWarmStart[i] = false;
+      if (!stable) Serial.printf("[简易VOC] #%u 阻值 %.2f kΩ 超出快照范围, 等待传感器稳定\n", i, vals.gas_kOhm);
+    }
+  }
+  if (vocWarmStart[i]) {
+    // 读数来自尚未稳定的传感器: 只给出指数, 不推进基线
+    if (!vocWarm[i]) Serial.printf("[简易VOC] #%u 热启动, 首个样本即使用保存的基线: %.2f kΩ\n", i, b.value());
+    vocWarm[i] = true;
+    vals.simpleVocIndex = b.index(vals.gasComp_kOhm);
+    vals.gasBaseline_kOhm = b.value();
+    return;
+  }
+  if (stable != vocWarm[i]) {
+    vocWarm[i] = stable;
+    if (stable) {
+      Serial.printf("[简易VOC] #%u 传感器已稳定 (%s, 启动后 %lld s)\n", i, haveStatus ? "BSEC" : "固定延时",
+                    (long long)(vals.timestampMs / 1000));
+      if (b.established()) Serial.printf("[简易VOC] #%u 沿用基线: %.2f kΩ (已跟踪 %.1f h)\n", i, b.value(), b.trackedHours());
+    } else {
+      Serial.printf("[简易VOC] #%u 传感器未稳定 (重新初始化?), 暂停基线\n", i);
+    }
+  }
+  if (vocWarm[i] && vocProvisional[i] && runIn) {
+    b.clear();
+    vocProvisional[i] = false;
+    Serial.printf("[简易VOC] #%u 磨合完成, 重新建立基线\n", i);
+  }
+  if (vocWarm[i]) {
+    // 模型只用已稳定传感器的读数学习; 学习后重新补偿本样本
+    gasComp[i].update(vals.timestampMs, vals.gas_kOhm, t, h);
+    vals.gasComp_kOhm = gasComp[i].compensate(vals.gas_kOhm, t, h);
+  }
+  if (vocWarm[i] && !b.established()) {
+    b.seed(vals.gasComp_kOhm);
+    vocProvisional[i] = !runIn;
+    if (b.established()) Serial.printf("[简易VOC] #%u 基线建立: %.2f kΩ%s\n", i, b.value(), runIn ? "" : " (磨合中, 临时)");
+  }
+  if (vocWarm[i]) b.update(vals.timestampMs, vals.gasComp_kOhm);
+  vals.simpleVocIndex = vocWarm[i] ? b.index(vals.gasComp_kOhm) : NAN;
+  vals.gasBaseline_kOhm = b.value();
+}
+
+// 墙上时间 (Unix 秒), 用于判断快照的年龄; RTC 未设置时为 0
+int64_t wallClockSec() {
+#if defined(HOST_BUILD)
+  int64_t t = host::wallClockSec();
+#else
+  int64_t t = (int64_t)time(nullptr); // setup() 中已由 RTC 设置系统时间
+#endif
+  return t >= VALID_EPOCH_S ? t : 0;
+}
+
+// 快照与该传感器的 BSEC 状态放在同一命名空间, 键名为状态键加前缀 'v'
+void vocKey(uint8_t i, char *key, size_t len) {
+  snprintf(key, len, "v%s", sensorTable.stateKey[i]);
+}
+
+// 启动时加载快照: 超过 7 天丢弃; 30 分钟内 (且保存时已稳定) 允许从首个样本起直接给出指数; 其余沿用基线但等待传感器稳定。
+// 没有有效时间 (RTC 未设置) 时无法判断年龄, 按最后一种处理
+void loadVocBaselines() {
+  char ns[16];
+  stateNamespace(bsecConfigCrc.load(std::memory_order_acquire), ns, sizeof(ns));
+  int64_t now = wallClockSec();
+  Preferences prefs;
+  prefs.begin(ns, true);
+  for (uint8_t i = 0; i < sensorTable.count; ++i) {
+    char key[16];
+    VocBaselineBlob blob;
+    vocKey(i, key, sizeof(key));
+    if (prefs.getBytesLength(key) != sizeof(blob) || prefs.getBytes(key, &blob, sizeof(blob)) != sizeof(blob)) continue;
+    gasComp[i].restore(blob.compCoeffs); // 温湿度系数是传感器本身的特性, 基线过期也沿用
+    bool aged = now && blob.savedAtSec;
+    int64_t ageS = aged ? now - blob.savedAtSec : -1;
+    if (aged && (ageS < 0 || ageS > VOC_SNAPSHOT_MAX_AGE_S)) {
+      Serial.printf("[简易VOC] #%u 快照已过期 (%lld h), 重新建立基线\n", i, (long long)(ageS / 3600));
+      continue;
+    }
+    if (!vocBaselines[i].restore(blob)) continue;
+    vocWarmStart[i] = aged && ageS <= VOC_WARM_START_MAX_AGE_S && !isnan(blob.gasMin_kOhm) && !isnan(blob.gasMax_kOhm);
+    vocSavedMin[i] = blob.gasMin_kOhm;
+    vocSavedMax[i] = blob.gasMax_kOhm;
+    Serial.printf("[简易VOC] #%u 已加载基线: %.2f kΩ (%s)\n", i, vocBaselines[i].value(),
+                  vocWarmStart[i] ? "热启动" : aged ? "等待传感器稳定" : "年龄未知, 等待传感器稳定");
+    if (aged) Serial.printf("[简易VOC] #%u 快照保存于 %lld s 前\n", i, (long long)ageS);
+  }
+  prefs.end();
+}
+
+// loop(): 取用采集任务发布的传感器表; 清除 sensorsReinitDue 之后采集任务才会再次重建
+void takeSensorTable() {
+  sensorTable = pendingSensorTable;
+#if defined(USE_BSEC2)
+  snprintf(activeConfigName, sizeof(activeConfigName), "%s", pendingConfigName);
+#endif
+  sensorsReinitDue.store(false, std::memory_order_release);
+}
+
+// 清除各槽位的简易 VOC 状态 (基线、补偿模型、稳定/热启动标志、阻值窗口) 后按当前配置与传感器顺序重新加载
+void reloadVocState() {
+  for (uint8_t i = 0; i < MAX_SENSORS; ++i) {
+    vocBaselines[i].clear();
+    gasComp[i].clear();
+    vocWarm[i] = vocWarmStart[i] = vocProvisional[i] = false;
+    vocSavedMin[i] = vocSavedMax[i] = NAN;
+    rolling[i][ROLLING_GAS].clear();
+  }
+  loadVocBaselines();
+}
+
+// 写入 prefs 已打开的命名空间 (saveState 或 saveVocBaselines 中调用)。只保存已稳定传感器的快照:
+// 未稳定时没有推进基线, 保存只会刷新时间戳, 让旧基线冒充新的
+void putVocBaseline(Preferences &prefs, uint8_t i) {
+  if (!vocBaselines[i].established() || !vocWarm[i] || vocWarmStart[i]) return;
+  char key[16];
+  VocBaselineBlob blob;
+  vocKey(i, key, sizeof(key));
+  vocBaselines[i].save(blob);
+  gasComp[i].save(blob.compCoeffs);
+  blob.savedAtSec = wallClockSec();
+  blob.gasMin_kOhm = rolling[i][ROLLING_GAS].min();
+  blob.gasMax_kOhm = rolling[i][ROLLING_GAS].max();
+  prefs.putBytes(key, &blob, sizeof(blob));
+}
+
+void saveVocBaselines() {
+  char ns[16];
+  stateNamespace(bsecConfigCrc.load(std::memory_order_acquire), ns, sizeof(ns));
+  Preferences prefs;
+  prefs.begin(ns, false);
+  for (uint8_t i = 0; i < sensorTable.count; ++i) putVocBaseline(prefs, i);
+  prefs.end();
+}
+
+void printVocBaselines() {
+  Serial.println("=== 简易 VOC 基线 ===");
+  for (uint8_t i = 0; i < sensorTable.count; ++i) {
+    const VocBaseline &b = vocBaselines[i];
+    if (b.established()) {
+      Serial.printf("%c#%u 基线 %.2f kΩ, 已跟踪 %.1f h%s%s\n", i == uiSensor ? '*' : ' ', i, b.value(), b.trackedHours(),
+                    vocWarmStart[i] ? " (热启动)" : vocWarm[i] ? "" : " (未稳定)", vocProvisional[i] ? " (磨合中, 临时)" : "");
+    } else {
+      Serial.printf("%c#%u 未建立%s\n", i == uiSensor ? '*' : ' ', i, vocWarm[i] ? "" : " (未稳定)");
+    }
+    const GasCompensation &c = gasComp[i];
+    Serial.printf("   温湿度补偿: 湿度 %+.2f%%/%%RH, 温度 %+.2f%%/°C (更新 %u, 视为 VOC 事件跳过 %u)\n", c.humidityPctPerRh(),
+                  c.tempPctPerC(), c.updates(), c.rejected());
+  }
+  Serial.println("================");
+}
+
+// 以样本时间戳推进各通道的滑动窗口, 把窗口内的最小/最大值写回样本
+void updateRolling(SensorValues &vals) {
+  for (uint8_t f = 0; f < ROLLING_FIELD_COUNT; ++f) {
+    const RollingField &rf = ROLLING_FIELDS[f];
+    RollingExtrema<ROLLING_SLOTS> &r = rolling[vals.sensor][f];
+    r.push(vals.timestampMs, vals.*rf.value);
+    vals.*rf.min = r.min();
+    vals.*rf.max = r.max();
+  }
+}
+
+// 修改通道 f 在所有传感器上的窗口长度, 已有样本清空
+void setRollingWindow(uint8_t f, uint32_t ms) {
+  for (uint8_t i = 0; i < MAX_SENSORS; ++i) rolling[i][f].setWindow(ms);
+}
+
+void printRolling() {
+  Serial.printf("=== 滑动窗口 (传感器 #%u) ===\n", uiSensor);
+  for (uint8_t f = 0; f < ROLLING_FIELD_COUNT; ++f) {
+    const RollingExtrema<ROLLING_SLOTS> &r = rolling[uiSensor][f];
+    Serial.printf("%-9s 窗口 %6u s: 最小 %9.2f, 最大 %9.2f\n", ROLLING_FIELDS[f].name, r.window() / 1000, r.min(), r.max());
+  }
+  Serial.println("================");
+}
+
+// 变点检测: 传感器稳定后逐个样本推进各通道的 CUSUM, 开始/结束事件放入 eventQueue
+void detectChanges(const SensorValues &vals) {
+  uint8_t i = vals.sensor;
+  if (!vocWarm[i]) return;
+  for (uint8_t c = 0; c < EVENT_CHANNEL_COUNT; ++c) {
+    const EventChannel &ec = EVENT_CHANNELS[c];
+    if (ec.accuracy && vals.*ec.accuracy < 1) continue;
+    if (ec.compensated && !gasComp[i].learned()) continue;
+    float x = vals.*ec.value;
+    if (ec.logScale) x = x > 0 ? 100.0f * logf(x) : NAN;
+    ChangeEvent ev;
+    if (!changeDetectors[i][c].update(vals.timestampMs, x, ev)) continue;
+    ev.sensor = i;
+    ev.channel = c;
+    if (!eventQueue.push(ev)) Serial.printf("[事件] 队列已满, 丢弃 #%u %s 事件\n", i, ec.name);
+  }
+}
+
+// CSV: 开始事件的 duration 为检测延迟 (确认时刻 - 估计起点), 结束事件的 duration 为事件持续时间
+void printEventLine(const ChangeEvent &ev) {
+  Serial.printf("event,%s,%u,%s,%lld,%lld,%.1f,%lld\n", ev.start ? "start" : "end", ev.sensor, EVENT_CHANNELS[ev.channel].name,
+                (long long)ev.timestampMs, (long long)ev.onsetMs, ev.magnitude, (long long)(ev.timestampMs - ev.onsetMs));
+}
+
+// 事件消费者: 串口 CSV 日志 (表头见 printEvents) 与最近事件列表; 告警/上报消费者也挂在这里
+void processEvent(const ChangeEvent &ev) {
+  printEventLine(ev);
+  recentEvents[eventCount % RECENT_EVENTS] = ev;
+  ++eventCount;
+}
+
+void printEvents() {
+  Serial.printf("=== 变点事件 (共 %u 个) ===\n", eventCount);
+  for (uint8_t c = 0; c < EVENT_CHANNEL_COUNT; ++c) {
+    const ChangeDetector &d = changeDetectors[uiSensor][c];
+    Serial.printf("%-4s #%u 参考 %8.2f, 累积 %6.1f / %.0f%s\n", EVENT_CHANNELS[c].name, uiSensor, d.reference(), d.statistic(),
+                  EVENT_CHANNELS[c].h, d.inEvent() ? " (事件中)" : "");
+  }
+  Serial.println("event,type,sensor,channel,ts_ms,onset_ms,magnitude,duration_ms");
+  uint32_t first = eventCount > RECENT_EVENTS ? eventCount - RECENT_EVENTS : 0;
+  for (uint32_t n = first; n < eventCount; ++n) printEventLine(recentEvents[n % RECENT_EVENTS]);
+  Serial.println("================");
+}
+
+// 每个样本更新三级统计的当前桶 (每通道一次 Welford 更新)
+void updateRollups(const SensorValues &vals) {
+  uint8_t i = vals.sensor;
+  if (!rollups[i]) {
+    rollups[i] = new (std::nothrow) Rollup[ROLLUP_LEVEL_COUNT];
+    if (!rollups[i]) {
+      static bool warned = false;
+      if (!warned) Serial.printf("[统计] #%u 内存不足, 不做多分辨率统计\n", i);
+      warned = true;
+      return;
+    }
+    for (uint8_t l = 0; l < ROLLUP_LEVEL_COUNT; ++l) rollups[i][l].setResolution(ROLLUP_LEVELS[l].ms);
+  }
+  float x[STAT_FIELD_COUNT];
+  for (uint8_t f = 0; f < STAT_FIELD_COUNT; ++f) x[f] = vals.*STAT_FIELDS[f].value;
+  for (uint8_t l = 0; l < ROLLUP_LEVEL_COUNT; ++l) rollups[i][l].push(vals.timestampMs, x);
+}
+
+// 界面/串口/网络等消费者的查询入口: 传感器 i 通道 f 在第 level 级最近 buckets 个桶 (含当前桶) 的统计,
+// 如 rollupStats(i, f, 0, 60) 为最近一小时; 没有样本时 n = 0
+RunningStats rollupStats(uint8_t i, uint8_t f, uint8_t level, uint16_t buckets) {
+  if (i >= MAX_SENSORS || !rollups[i] || f >= STAT_FIELD_COUNT || level >= ROLLUP_LEVEL_COUNT) return RunningStats();
+  return rollups[i][level].recent(f, buckets);
+}
+
+void printRollups() {
+  static const struct { const char *label; uint8_t level; uint16_t buckets; } SPANS[] = {
+    {"1 小时", 0, 60}, {"24 小时", 1, 24}, {"7 天", 2, 7}};
+  Serial.printf("=== 统计 (传感器 #%u, 均值 ± 标准差 [最小, 最大]) ===\n", uiSensor);
+  for (const auto &span : SPANS) {
+    Serial.printf("-- 最近 %s --\n", span.label);
+    for (uint8_t f = 0; f < STAT_FIELD_COUNT; ++f) {
+      RunningStats st = rollupStats(uiSensor, f, span.level, span.buckets);
+      if (st.n == 0) continue;
+      Serial.printf("%-9s %10.2f ± %-8.2f [%.2f, %.2f] (%u 个样本)\n", STAT_FIELDS[f].name, st.mean, st.stddev(), st.min, st.max, st.n);
+    }
+  }
+  Serial.println("================");
+}
+
+// 某一级保留的全部桶, CSV 输出供导出
+void printRollupBuckets(uint8_t level) {
+  Serial.println("rollup,sensor,level,start_ms,channel,n,mean,sd,min,max");
+  const Rollup *r = rollups[uiSensor] ? &rollups[uiSensor][level] : nullptr;
+  for (uint16_t back = r ? r->size() : 0; back-- > 0;) {
+    for (uint8_t f = 0; f < STAT_FIELD_COUNT; ++f) {
+      RunningStats st;
+      int64_t startMs = 0;
+      if (!r->bucket(f, back, st, &startMs) || st.n == 0) continue;
+      Serial.printf("rollup,%u,%s,%lld,%s,%u,%.3f,%.3f,%.3f,%.3f\n", uiSensor, ROLLUP_LEVELS[level].name, (long long)startMs,
+                    STAT_FIELDS[f].name, st.n, st.mean, st.stddev(), st.min, st.max);
+    }
+  }
+}
+
+void printHistory() {
+  Serial.println("=== 样本历史 ===");
+  if (!history.active()) {
+    Serial.println("未分配");
+    Serial.println("================");
+    return;
+  }
+  uint64_t n = history.samplesWritten();
+  float bytesPerSample = n ? history.bitsWritten() / 8.0f / n : 0.0f;
+  Serial.printf("池 %u KB, 已用 %u/%u 块, 平均 %.2f 字节/样本 (%u 个通道)\n", (unsigned)(history.poolBytes() / 1024),
+                history.blocksUsed(), history.blockCount(), bytesPerSample, HISTORY_FIELD_COUNT);
+  if (bytesPerSample > 0) {
+    // 块头与块尾留白约占 1%, 按当前采样周期、所有传感器共享池估算
+    float samplesFit = history.poolBytes() * 0.99f / bytesPerSample / (sensorTable.count ? sensorTable.count : 1);
+    Serial.printf("按当前周期 %.1f s 可保存约 %.1f 天/传感器\n", samplePeriodMs(sampleMode) / 1000.0f,
+                  samplesFit * samplePeriodMs(sampleMode) / 86400000.0f);
+  }
+  for (uint8_t i = 0; i < sensorTable.count; ++i) {
+    int64_t oldest, newest;
+    uint32_t blocks;
+    uint32_t count = history.samples(i, oldest, newest, blocks);
+    Serial.printf("#%u: %u 个样本, %u 块, %.2f h (%lld - %lld ms)\n", i, count, blocks, (newest - oldest) / 3600000.0f,
+                  (long long)oldest, (long long)newest);
+  }
+  Serial.println("================");
+}
+
+// 当前传感器最近 minutes 分钟的历史, CSV 输出供导出/画趋势图
+void exportHistory(uint32_t minutes) {
+  int64_t oldest, newest;
+  uint32_t blocks;
+  if (!history.samples(uiSensor, oldest, newest, blocks)) {
+    Serial.println("[历史] 没有样本");
+    return;
+  }
+  Serial.print("hist,sensor,ts_ms");
+  for (uint8_t f = 0; f < HISTORY_FIELD_COUNT; ++f) Serial.printf(",%s", HISTORY_FIELDS[f].name);
+  Serial.println();
+  HistoryCursor c = history.query(uiSensor, newest - (int64_t)minutes * 60000LL, newest);
+  HistorySample h;
+  while (c.next(h)) {
+    Serial.printf("hist,%u,%lld", uiSensor, (long long)h.timestampMs);
+    for (uint8_t f = 0; f < HISTORY_FIELD_COUNT; ++f) Serial.printf(",%g", h.v[f]);
+    Serial.println();
+  }
+}
+
+// 每个样本一条 LOG_SAMPLE 记录 (STAT_FIELDS 各通道), 写入即落盘
+void logSample(const SensorValues &vals) {
+  if (!flashLog.active()) return;
+  LogSample r;
+  r.timestampMs = vals.timestampMs;
+  r.epochSec = (uint32_t)wallClockSec();
+  r.sensor = vals.sensor;
+  r.iaqAccuracy = vals.iaqAccuracy;
+  r.fields = STAT_FIELD_COUNT;
+  r.reserved = 0;
+  for (uint8_t f = 0; f < STAT_FIELD_COUNT; ++f) r.v[f] = vals.*STAT_FIELDS[f].value;
+  uint32_t t0 = StageTimers::now();
+  bool ok = flashLog.append(LOG_SAMPLE, &r, sizeof(r));
+  stageTimers.end(STAGE_FLASH_LOG, t0);
+  static uint32_t warnedErrors = 0;
+  if (!ok && flashLog.errors() != warnedErrors) {
+    warnedErrors = flashLog.errors();
+    Serial.printf("[日志] flash 写入失败 (累计 %u 次), 下一条另起新块\n", warnedErrors);
+  }
+}
+
+void printFlashLog() {
+  Serial.println("=== flash 样本日志 ===");
+  if (!flashLog.active()) {
+    Serial.println("没有 samplelog 分区");
+    Serial.println("======================");
+    return;
+  }
+  FlashLogStats s = flashLog.stats();
+  Serial.printf("分区 %u KB, 有效块 %u/%u, 块序号 %u - %u, 扇区擦除次数 %u - %u\n", s.blocks * FlashLog::BLOCK_BYTES / 1024,
+                s.valid, s.blocks, s.oldestSeq, s.newestSeq, s.minErase, s.maxErase);
+  Serial.printf("本次启动: %u 条记录, %llu 字节, 擦除 %u 块, 写入失败 %u 次, 启动恢复 %u us\n", flashLog.recordsWritten(),
+                (unsigned long long)flashLog.bytesWritten(), flashLog.erases(), flashLog.errors(), flashLog.recoveryUs());
+  // 按当前周期、所有传感器估算: 保留时长与每个扇区的擦除频率 (块头与块尾留白按 2% 计)
+  float perDay = 86400000.0f / samplePeriodMs(sampleMode) * (sensorTable.count ? sensorTable.count : 1);
+  float blocksPerDay = perDay * (sizeof(LogSample) + 8) / (FlashLog::BLOCK_BYTES * 0.98f);
+  float cyclesPerDay = blocksPerDay / s.blocks;
+  Serial.printf("按当前周期 %.1f s: 保留约 %.1f 小时, 每扇区每天擦除 %.2f 次, %u 次寿命约 %.0f 年\n",
+                samplePeriodMs(sampleMode) / 1000.0f, s.blocks / blocksPerDay * 24.0f, cyclesPerDay,
+                FLASH_ENDURANCE_CYCLES, FLASH_ENDURANCE_CYCLES / cyclesPerDay / 365.0f);
+  Serial.println("======================");
+}
+
+// 从最旧的记录开始, 以 CSV 输出日志中的全部样本
+void dumpFlashLog() {
+  if (!flashLog.active()) {
+    Serial.println("[日志] 没有 samplelog 分区");
+    return;
+  }
+  Serial.print("log,block,epoch_s,ts_ms,sensor,iaq_acc");
+  for (uint8_t f = 0; f < STAT_FIELD_COUNT; ++f) Serial.printf(",%s", STAT_FIELDS[f].name);
+  Serial.println();
+  FlashLogCursor c = flashLog.read();
+  uint8_t type, buf[FlashLog::MAX_PAYLOAD];
+  uint16_t len;
+  uint32_t seq, n = 0;
+  while (c.next(type, buf, len, &seq)) {
+    if (type != LOG_SAMPLE || len != sizeof(LogSample)) continue;
+    LogSample r;
+    memcpy(&r, buf, sizeof(r));
+    if (r.fields != STAT_FIELD_COUNT) continue;
+    Serial.printf("log,%u,%u,%lld,%u,%u", seq, r.epochSec, (long long)r.timestampMs, r.sensor, r.iaqAccuracy);
+    for (uint8_t f = 0; f < STAT_FIELD_COUNT; ++f) Serial.printf(",%g", r.v[f]);
+    Serial.println();
+    ++n;
+  }
+  Serial.printf("[日志] 共 %u 条\n", n);
+}
+
+// 高速温湿压样本: 亚秒级气压/湿度变化的消费者挂在这里
+void processFastSample(const FastTphSample &v) {
+  if (fastLog) Serial.printf("fast,%u,%lld,%.2f,%.2f,%.3f\n", v.sensor, (long long)v.timestampMs, v.temperature, v.humidity, v.pressure_hPa);
+}
+
+// 气体向量: 以 CSV 行输出到串口, 供采集训练数据或外部分类器读取 (表头见 printScanHeader)
+void processGasVector(const GasVector &v) {
+  Serial.printf("scan,%u,%u,%lld,%s,%.2f,%.2f,%.2f,%03x", v.sensor, v.cycle, (long long)v.timestampMs, scanLabel,
+                v.temperature, v.humidity, v.pressure_hPa, v.stableMask);
+  for (uint8_t i = 0; i < v.len; ++i) Serial.printf(",%.3f", v.gas_kOhm[i]);
+  Serial.println();
+}
+
+void printScanHeader() {
+  Serial.print("scan,sensor,cycle,ms,label,t_c,h_pct,p_hpa,stable");
+  for (uint8_t i = 0; i < scanProfile.len; ++i) Serial.printf(",r%u_%uc_kohm", i, scanProfile.tempC[i]);
+  Serial.println();
+}
+
+void setAutoRate(bool on) {
+  rateController.setEnabled(on);
+  bsecConsumers.pause(rateConsumer, !on);
+  requestAcquisition(0);
+}
+
+void printSampleStats() {
+  uint32_t produced = samplesProduced.load(std::memory_order_relaxed);
+  uint32_t dropped = sampleQueue.dropped();
+  float minutes = monotonicMs() / 60000.0f; // 64 位单调时钟, millis() 约 49.7 天回绕
+  Serial.println("=== 数据管线 ===");
+  Serial.printf("BSEC 输出 %u, 已处理 %u, 丢弃 %u, 队列中 %u\n", produced, samplesProcessed, dropped, (unsigned)sampleQueue.size());
+  Serial.printf("有效数据率: %.2f 样本/分钟 (采样周期 %.1f s)\n", minutes > 0 ? samplesProcessed / minutes : 0.0f, samplePeriodMs(sampleMode) / 1000.0f);
+  if (rawRecorder.active() || rawRecorder.dropped() || rawRecorder.droppedMarkers()) {
+    Serial.printf("录制: 已写入 %u 帧, 队列满丢弃 %u 帧、%u 个标记%s\n", rawRecorder.frames(), rawRecorder.dropped(),
+                  rawRecorder.droppedMarkers(), rawRecorder.active() ? "" : " (已停止)");
+  }
+  if (acqLogQueue.dropped()) Serial.printf("采集任务日志: 队列满丢弃 %u 行\n", acqLogQueue.dropped());
+  Serial.println("================");
+}
+
+// `sensors` 命令: 采集任务填写的各槽位运行状态, 位置取自 loop() 的传感器表
+void printSensors(const SensorReport &r) {
+  uint32_t busyUs = 0;
+  Serial.printf("=== 传感器 (%u 个, %s) ===\n", r.count, r.mux ? "经 TCA9548A" : "主总线");
+  for (uint8_t i = 0; i < r.count; ++i) {
+    const char *where = i < sensorTable.count ? sensorTable.where[i] : "?"; // 传感器表尚未取用
+    Serial.printf("%c#%u %-14s 输出 %6u, 测量耗时 %6u us, %s\n", i == uiSensor ? '*' : ' ', i, where, r.outputs[i],
+                  r.runUs[i], r.status[i]);
+    busyUs += r.runUs[i];
   }
+  Serial.printf("顺序测量 %u ms / 周期 %u ms, 总线占用 %.1f%%\n", busyUs / 1000, r.periodMs,
+                r.periodMs ? busyUs / 10.0f / r.periodMs : 0.0f);
+  Serial.println("================");
+}
+
+// loop(): 输出采集任务填好的诊断快照, 输出后采集任务才会再次填写
+void printReports() {
+  uint32_t ready = reportsReady.load(std::memory_order_acquire);
+  if (!ready) return;
+  const AcqReports &r = acqReports;
+  if (ready & ACQ_REQ_I2C_SCAN) r.i2c.print();
+  if (ready & ACQ_REQ_PRINT_SENSORS) printSensors(r.sensors);
+  if (ready & ACQ_REQ_PRINT_SCAN) r.scan.print(scanProfile);
+  if (ready & ACQ_REQ_PRINT_FAST) r.fast.print(r.fastNowUs);
+  if (ready & ACQ_REQ_PRINT_JOBS) r.jobs.printStats();
+  if (ready & ACQ_REQ_PRINT_SUBS) bsecConsumers.print(r.subs);
+  if (ready & ACQ_REQ_PRINT_RATE) r.rate.print(r.rateNowMs);
+  reportsReady.fetch_and(~ready, std::memory_order_release);
+}
+
+// loop(): 把采集任务的日志行写到串口
+void printAcqLog() {
+  LogLine line;
+  while (acqLogQueue.pop(line)) Serial.print(line.text);
+}
+
+void showSample(const SensorValues &vals) {
+  uint32_t t0 = StageTimers::now();
+  updateDynamicUI(vals);
+  stageTimers.end(STAGE_UI, t0);
+
+  // Serial formatted block
+  t0 = StageTimers::now();
+  Serial.println("\n╔════════════════════════════════════╗");
+#if defined(USE_BSEC2)
+  Serial.println("║  BME688 环境传感器数据 (BSEC2+简易) ║");
+#else
+  Serial.println("║  BME688 环境传感器数据 (直驱+简易)  ║");
+#endif
+  Serial.println("╠════════════════════════════════════╣");
+  if (sensorTable.count > 1) {
+    Serial.printf("║ 传感器:   #%u/%u %-14s    ║\n", vals.sensor, sensorTable.count, sensorTable.where[vals.sensor]);
+  }
+  Serial.printf("║ 温度:      %6.2f °C            ║\n", vals.compTemperature);
+  Serial.printf("║ 湿度:      %6.2f %%             ║\n", vals.compHumidity);
+  Serial.printf("║ 气压:    %7.2f hPa           ║\n", vals.pressure_hPa);
+  Serial.printf("║ 气体阻值: %6.2f kΩ            ║\n", vals.gas_kOhm);
+  Serial.printf("║ 补偿阻值: %6.2f kΩ            ║\n", vals.gasComp_kOhm);
+  Serial.printf("║ 窗口范围: %6.2f-%-6.2f kΩ     ║\n", vals.gasMinWindow_kOhm, vals.gasMaxWindow_kOhm);
+  Serial.printf("║ 海拔高度: %6.2f m             ║\n", vals.altitude_m);
+  RunningStats hourT = rollupStats(vals.sensor, STAT_TEMP, 0, 60), hourH = rollupStats(vals.sensor, STAT_HUM, 0, 60);
+  Serial.printf("║ 1h 均值:  %5.2f °C / %5.2f %%   ║\n", hourT.mean, hourH.mean);
+#if defined(USE_BSEC2)
+  Serial.printf("║ IAQ:       %6.2f (精度:%d)      ║\n", vals.iaq, vals.iaqAccuracy);
+  Serial.printf("║ CO2eq:     %6.2f ppm           ║\n", vals.co2eq);
+  Serial.printf("║ VOCeq:     %6.2f ppm           ║\n", vals.vocEq);
+#endif
+  Serial.printf("║ 简易VOC:  %6.2f (级别:%s)   ║\n", vals.simpleVocIndex, classifySimpleVoc(vals.simpleVocIndex));
+  Serial.printf("║ 读取耗时: %6u us              ║\n", vals.readUs);
+  Serial.printf("║ 样本:  处理 %6u / 丢弃 %4u    ║\n", samplesProcessed, sampleQueue.dropped());
+  Serial.println("╚════════════════════════════════════╝");
+  stageTimers.end(STAGE_SERIAL, t0);
 }
 
 void loop() {
+#ifdef HOST_BUILD
+  acquisitionStep(); // 主机上没有 FreeRTOS, 采集与显示在同一线程交替执行
+#endif
+  int64_t wakeUs = esp_timer_get_time();
+  if (!loopStatsSinceUs) loopStatsSinceUs = wakeUs;
+  uint32_t t0 = StageTimers::now();
   M5.update();
+  stageTimers.end(STAGE_M5_UPDATE, t0);
+  pollSerialCommands();
 
   if (M5.BtnA.wasPressed()) {
     Serial.println("[BtnA] 手动刷新");
-    lastUpdate = 0; // force
+    requestAcquisition(ACQ_REQ_REFRESH);
   }
   if (M5.BtnB.wasPressed()) {
     Serial.println("[BtnB] I2C 扫描");
-    i2cScan();
+    requestAcquisition(ACQ_REQ_I2C_SCAN);
   }
   if (M5.BtnC.wasPressed()) {
     Serial.println("[BtnC] 重新初始化传感器");
-    initBsec2();
+    rebuildPending.store(true, std::memory_order_release);
+    requestAcquisition(ACQ_REQ_REINIT);
   }
 
-  unsigned long now = millis();
-  bool got = envSensor.run(); // 高频调用, 内部决定是否有新输出
-  if (got && (now - lastUpdate >= UPDATE_INTERVAL_MS)) {
-    lastUpdate = now;
-    uint32_t tStart = millis();
-      uint32_t readMs = millis() - tStart;
-      SensorValues vals;
-      vals.readMs = readMs;
-      auto dTemp = envSensor.getData(BSEC_OUTPUT_RAW_TEMPERATURE);
-      auto dHum = envSensor.getData(BSEC_OUTPUT_RAW_HUMIDITY);
-      auto dPress = envSensor.getData(BSEC_OUTPUT_RAW_PRESSURE);
-      auto dGas = envSensor.getData(BSEC_OUTPUT_RAW_GAS);
-      auto dIaq = envSensor.getData(BSEC_OUTPUT_IAQ);
-      auto dCo2 = envSensor.getData(BSEC_OUTPUT_CO2_EQUIVALENT);
-      auto dVoc = envSensor.getData(BSEC_OUTPUT_BREATH_VOC_EQUIVALENT);
-
-      vals.temperature = dTemp.signal;
-      vals.humidity = dHum.signal;
-      // 压力单位自适应: 若值>5000 认为是 Pa, 否则已是 hPa
-      static bool pressureDebugPrinted = false;
-      float rawPress = dPress.signal;
-      if (!pressureDebugPrinted) {
-        Serial.printf("[DEBUG] 原始压力输出 raw=%.2f\n", rawPress);
-        pressureDebugPrinted = true;
-      }
-      if (rawPress > 5000.0f) {
-        vals.pressure_hPa = rawPress / 100.0f; // Pa->hPa
-      } else {
-        vals.pressure_hPa = rawPress; // 已是 hPa
-      }
-      vals.gas_kOhm = dGas.signal / 1000.0f; // Ohm -> kOhm
-      vals.altitude_m = calcAltitude(vals.pressure_hPa);
-      vals.iaq = dIaq.signal;
-      vals.iaqAccuracy = dIaq.accuracy;
-      vals.co2eq = dCo2.signal;
-      vals.vocEq = dVoc.signal;
-
-      // 建立基线逻辑：启动 2 分钟后锁定一次当前阻值作为基线 (若未建立)
-      if (!baselineEstablished && now > BASELINE_DELAY_MS) {
-        gasBaseline = vals.gas_kOhm;
-        baselineEstablished = true;
-        gasMinWindow = gasBaseline; // 初始化窗口最小值
-        Serial.printf("[简易VOC] 基线建立: %.2f kΩ\n", gasBaseline);
-      }
+  // 重建实例后传感器的命名空间/顺序可能已变: 先把旧配置取出的状态连同旧基线落盘, 再换上新的传感器表重新加载
+  if (sensorsReinitDue.load(std::memory_order_acquire)) {
+    if (pendingStateMask.load(std::memory_order_acquire)) saveState();
+    takeSensorTable();
+    reloadVocState();
+    if (acqRequests.load(std::memory_order_acquire)) xTaskNotifyGive(acqTaskHandle); // 被推迟的重建请求
+  }
+#if defined(USE_BSEC2)
+  if (configSaveDue.load(std::memory_order_acquire)) saveConfigSelection();
+#endif
 
-      // 周期性重置窗口最小值用于对比
-      if (baselineEstablished && (now - lastWindowUpdate) > WINDOW_UPDATE_INTERVAL_MS) {
-        gasMinWindow = vals.gas_kOhm; // 重置为当前值再继续追踪最小
-        lastWindowUpdate = now;
-        Serial.printf("[简易VOC] 窗口重置, 当前阻值=%.2f kΩ\n", vals.gas_kOhm);
-      }
+  // 每个样本都进入数据管线; 界面只在 "ui" 任务到期时用最新样本刷新一次
+  static SensorValues latest[MAX_SENSORS];
+  static uint16_t haveLatest = 0;
+  SensorValues vals;
+  while (sampleQueue.pop(vals)) {
+    processSample(vals);
+    latest[vals.sensor] = vals;
+    haveLatest |= 1u << vals.sensor;
+  }
+  GasVector vec;
+  while (vectorQueue.pop(vec)) processGasVector(vec);
+  FastTphSample fast;
+  while (fastQueue.pop(fast)) processFastSample(fast);
+  ChangeEvent ev;
+  while (eventQueue.pop(ev)) processEvent(ev);
+  if ((haveLatest >> uiSensor & 1) && uiRefreshDue.exchange(false, std::memory_order_acq_rel)) showSample(latest[uiSensor]);
 
-      vals.simpleVocIndex = computeSimpleVocIndex(vals.gas_kOhm);
-      vals.gasBaseline_kOhm = gasBaseline;
-      vals.gasMinWindow_kOhm = gasMinWindow;
+  if (vocSaveDue.exchange(false, std::memory_order_acq_rel)) saveVocBaselines();
 
-      updateDynamicUI(vals);
+  // Periodic state save
+  if (pendingStateMask.load(std::memory_order_acquire)) {
+    t0 = StageTimers::now();
+    saveState();
+    stageTimers.end(STAGE_SAVE_STATE, t0);
+  }
 
-      // Periodic state save
-      if (vals.iaqAccuracy == 3 && (now - lastStateSave >= 5UL * 60UL * 1000UL)) { // 精度3后每5min保存
-        saveState();
-        lastStateSave = now;
-      }
+  rawRecorder.drain();
+  printAcqLog();
+  printReports();
 
-      // Serial formatted block
-      Serial.println("\n╔════════════════════════════════════╗");
-      Serial.println("║  BME688 环境传感器数据 (BSEC2+简易) ║");
-      Serial.println("╠════════════════════════════════════╣");
-      Serial.printf("║ 温度:      %6.2f °C            ║\n", vals.temperature);
-      Serial.printf("║ 湿度:      %6.2f %%             ║\n", vals.humidity);
-      Serial.printf("║ 气压:    %7.2f hPa           ║\n", vals.pressure_hPa);
-      Serial.printf("║ 气体阻值: %6.2f kΩ            ║\n", vals.gas_kOhm);
-      Serial.printf("║ 海拔高度: %6.2f m             ║\n", vals.altitude_m);
-      Serial.printf("║ IAQ:       %6.2f (精度:%d)      ║\n", vals.iaq, vals.iaqAccuracy);
-      Serial.printf("║ CO2eq:     %6.2f ppm           ║\n", vals.co2eq);
-      Serial.printf("║ VOCeq:     %6.2f ppm           ║\n", vals.vocEq);
-      Serial.printf("║ 简易VOC:  %6.2f (级别:%s)   ║\n", vals.simpleVocIndex, classifySimpleVoc(vals.simpleVocIndex));
-      Serial.printf("║ 读取耗时:  %3u ms               ║\n", vals.readMs);
-      Serial.println("╚════════════════════════════════════╝");
-  } else if (!got) {
-    static bool warnedOnce = false;
-    if (!warnedOnce) {
-      Serial.printf("[WARN] 暂无新数据 (bsecStatus=%d, bmeStatus=%d) 等待稳定...\n", envSensor.status, envSensor.sensor.status);
-      warnedOnce = true;
-    }
-  }
+  ++loopWakeups;
+  loopBusyUs += esp_timer_get_time() - wakeUs;
+#ifdef HOST_BUILD
+  // 主机: 两个"核"都无事可做时直接快进虚拟时钟到下一次 BSEC 截止时刻 (最多 LOOP_IDLE_MS, 与设备上 loop() 的唤醒节奏一致)
+  ulTaskNotifyTake(pdTRUE, std::min(acquisitionIdleTicks(), pdMS_TO_TICKS(LOOP_IDLE_MS)));
+#else
+  // 睡到采集任务发布新内容, 最多 LOOP_IDLE_MS; 不再空转占满 core 1
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOOP_IDLE_MS));
+#endif
+}
+
+// `timing`: loop() 的唤醒频率与占空比 (忙碌时间 / 经过时间)
+void printLoopDuty() {
+  int64_t elapsedUs = esp_timer_get_time() - loopStatsSinceUs;
+  float seconds = elapsedUs / 1e6f;
+  Serial.printf("loop(): %.1f s 内唤醒 %u 次 (%.1f 次/s), 平均每次 %u us, 占空 %.2f%%\n", seconds, loopWakeups,
+                seconds > 0 ? loopWakeups / seconds : 0.0f, loopWakeups ? (unsigned)(loopBusyUs / loopWakeups) : 0u,
+                elapsedUs > 0 ? loopBusyUs * 100.0f / elapsedUs : 0.0f);
 }
 
 bool initBsec2() {
-  // Initialize bsec2 library
-  // load state if available
-  if (!envSensor.begin(BME68X_I2C_ADDR_LOW, Wire)) { // try 0x76 first
-    if (!envSensor.begin(BME68X_I2C_ADDR_HIGH, Wire)) { // 0x77
-      return false;
+  // 扫描主总线与 TCA9548A 各通道, 每个 BME688 一个 Bsec2 实例; load state if available
+  uint8_t n = sensors.discover(Wire);
+  sensorsRebuilt = true;
+  for (uint8_t i = 0; i < MAX_SENSORS; ++i) sampleModeStats.subscribe(i, MODE_COUNT, monotonicMs()); // 重新 begin 后都未订阅
+
+#if defined(USE_BSEC2)
+  // 自定义配置 (AI-Studio 模型) 在 begin() 之后、setState() 之前加载; 所有传感器共用同一份 (flash 映射或 RAM 缓冲)
+  uint32_t crc = 0;
+  const uint8_t *cfg = nullptr;
+  if (strcmp(bsecConfigName, BSEC_CONFIG_DEFAULT) != 0) {
+    cfg = bsecConfigs.acquire(bsecConfigName, crc);
+    if (!cfg) {
+      acqLog("[配置] 没有可用的 %s, 使用库默认配置\n", bsecConfigName);
+      snprintf(bsecConfigName, sizeof(bsecConfigName), "%s", BSEC_CONFIG_DEFAULT);
+    }
+  }
+  bsecConfigCrc.store(crc, std::memory_order_release);
+  bsecConfigFailed = false;
+#endif
+
+  uint8_t ok = 0;
+  for (uint8_t i = 0; i < n; ++i) {
+    SensorSlot &s = sensors[i];
+    char where[24];
+    sensors.describe(i, where, sizeof(where));
+    if (!s.ok) {
+      acqLog("[传感器] #%u %s 初始化失败 (bsecStatus=%d)\n", i, where, s.bsec.status);
+      continue;
+    }
+#if defined(USE_BSEC2)
+    if (cfg && !s.bsec.setConfig(cfg)) {
+      acqLog("[配置] #%u 拒绝配置 %s (bsecStatus=%d)\n", i, bsecConfigName, s.bsec.status);
+      bsecConfigFailed = true;
+      break;
     }
+#endif
+    loadState(i);
+    s.bsec.attachCallback(onBsecOutputs);
+    acqLog("[传感器] #%u %s\n", i, where);
+    ++ok;
+  }
+#if defined(USE_BSEC2)
+  if (bsecConfigFailed) {
+    // 与库版本不匹配或内容损坏: 以默认配置重新初始化 (所有实例重新 begin, 已 setConfig 的也一并恢复)
+    snprintf(bsecConfigName, sizeof(bsecConfigName), "%s", BSEC_CONFIG_DEFAULT);
+    bool ok = initBsec2();
+    bsecConfigFailed = true;
+    return ok;
+  }
+  if (cfg) acqLog("[配置] BSEC 配置: %s (crc=%08x)\n", bsecConfigName, (unsigned)crc);
+#endif
+  if (sensors.hasMux()) acqLog("[传感器] TCA9548A 多路复用器 0x%02X, 共 %u 个传感器\n", MUX_ADDR, n);
+
+  // begin() 后 BSEC 没有任何订阅, 按消费者需求重新订阅 (各传感器错开相位)
+  bsecConsumers.takeChanged();
+  scheduleSensorConfig();
+  return ok > 0;
+}
+
+// 各消费者声明自己读取的 BSEC 输出; 新增消费者 (网络上报、告警等) 在这里登记
+// 简易 VOC 管线 (补偿阻值、基线/指数) 的输入: 气体阻值、补偿温湿度、稳定/磨合状态
+static const BsecOutputMask VOC_INPUTS = bsecMask(BSEC_OUTPUT_RAW_GAS, BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_TEMPERATURE,
+                                                  BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_HUMIDITY,
+                                                  BSEC_OUTPUT_STABILIZATION_STATUS, BSEC_OUTPUT_RUN_IN_STATUS);
+
+// 字段表中一个字段需要的输出; 派生字段需要简易 VOC 管线的输入
+static BsecOutputMask fieldNeeds(float SensorValues::*value, uint8_t SensorValues::*u8 = nullptr) {
+  BsecOutputMask m = bsecFieldMask(value, u8);
+  return m ? m : VOC_INPUTS;
+}
+
+void registerConsumers() {
+  // 界面/串口: 显示加热补偿后的温湿度 (温度偏移只作用于补偿输出)
+  bsecConsumers.add("ui", bsecMask(BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_TEMPERATURE,
+                                   BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_HUMIDITY,
+                                   BSEC_OUTPUT_RAW_PRESSURE, BSEC_OUTPUT_RAW_GAS, BSEC_OUTPUT_IAQ,
+                                   BSEC_OUTPUT_CO2_EQUIVALENT, BSEC_OUTPUT_BREATH_VOC_EQUIVALENT));
+  // 简易 VOC 基线/指数; 稳定/磨合状态决定何时建立基线
+  bsecConsumers.add("voc", VOC_INPUTS);
+  bsecConsumers.add("state", bsecMask(BSEC_OUTPUT_IAQ));     // 精度 3 后保存状态
+  // 数据管线中按字段表读取样本的消费者: 订阅由表生成, 表中加一行即自动订阅
+  BsecOutputMask events = 0, stats = 0, hist = 0;
+  for (uint8_t c = 0; c < EVENT_CHANNEL_COUNT; ++c) events |= fieldNeeds(EVENT_CHANNELS[c].value, EVENT_CHANNELS[c].accuracy);
+  for (uint8_t f = 0; f < STAT_FIELD_COUNT; ++f) stats |= fieldNeeds(STAT_FIELDS[f].value);
+  for (uint8_t f = 0; f < HISTORY_FIELD_COUNT; ++f) hist |= fieldNeeds(HISTORY_FIELDS[f].value, HISTORY_FIELDS[f].u8);
+  bsecConsumers.add("events", events);
+  bsecConsumers.add("stats", stats);
+  if (history.active()) bsecConsumers.add("history", hist);
+  if (flashLog.active()) bsecConsumers.add("log", stats | fieldNeeds(nullptr, &SensorValues::iaqAccuracy)); // LogSample 的字段
+  // 自适应采样率: 开启时才需要 (setAutoRate)
+  rateConsumer = bsecConsumers.add("rate", bsecMask(BSEC_OUTPUT_IAQ, BSEC_OUTPUT_RAW_GAS));
+  bsecConsumers.pause(rateConsumer, true);
+  // 录制只需要 BSEC 继续测量, 订阅一个原始输出即可
+  if (rawRecorder.active()) bsecConsumers.add("recorder", bsecMask(BSEC_OUTPUT_RAW_GAS));
+}
+
+// 采集任务中调用: 取消不再需要的输出, 按当前采样模式订阅新的并集; BSEC 实例与状态保持不变
+bool applySubscription(uint8_t i) {
+  SensorSlot &s = sensors[i];
+  BsecSubscription next = bsecSubscription(bsecConsumers.wanted());
+  BsecSubscription drop = bsecSubscription(s.activeMask & ~next.mask);
+  if (drop.count && !s.bsec.updateSubscription(drop.ids, drop.count, BSEC_SAMPLE_RATE_DISABLED)) {
+    acqLog("BSEC2 #%u 取消订阅失败\n", i);
+    return false;
   }
-  loadState();
-
-  // 设置温度偏移 (LP 模式)
-  envSensor.setTemperatureOffset(TEMP_OFFSET_LP);
-
-  // Subscribe to BSEC outputs of interest
-  bsec_virtual_sensor_t sensorList[] = {
-      BSEC_OUTPUT_RAW_TEMPERATURE,
-      BSEC_OUTPUT_RAW_PRESSURE,
-      BSEC_OUTPUT_RAW_HUMIDITY,
-      BSEC_OUTPUT_RAW_GAS,
-      BSEC_OUTPUT_IAQ,
-      BSEC_OUTPUT_STATIC_IAQ,
-      BSEC_OUTPUT_CO2_EQUIVALENT,
-      BSEC_OUTPUT_BREATH_VOC_EQUIVALENT,
-      BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_TEMPERATURE,
-      BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_HUMIDITY
-  };
-  bsec_sensor_configuration_t requestedSettings[sizeof(sensorList)/sizeof(sensorList[0])];
-  uint8_t numRequested = sizeof(sensorList)/sizeof(sensorList[0]);
-
-  if (!envSensor.updateSubscription(sensorList, numRequested, BSEC_SAMPLE_RATE_LP)) {
-    Serial.println("BSEC2 订阅失败");
+  if (next.count && !s.bsec.updateSubscription(next.ids, next.count, SAMPLE_MODES[sampleMode].rate)) {
+    acqLog("BSEC2 #%u 订阅失败\n", i);
+    s.pacer.setPeriodMs(0);
+    sampleModeStats.subscribe(i, MODE_COUNT, monotonicMs());
     return false;
   }
+  s.activeMask = next.mask;
+  clearBsecFields(s.values, s.activeMask);
+  s.periodMs = next.count ? samplePeriodMs(sampleMode) : 0;
+  s.pacer.setPeriodMs(s.periodMs);
+  sampleModeStats.subscribe(i, next.count ? sampleMode : MODE_COUNT, monotonicMs());
+  s.bsec.setTemperatureOffset(SAMPLE_MODES[sampleMode].tempOffset);
+  acqLog("[BSEC] #%u 订阅 %u 个输出 (mask=0x%08lx)\n", i, next.count, (unsigned long)s.activeMask);
+  return true;
+}
+
+// BSEC 以订阅 (速率变化) 的时刻为测量相位的起点: 传感器 i 推迟 i*周期/N 再订阅, 各自的测量在周期内均匀错开
+void scheduleSensorConfig() {
+  uint8_t n = sensors.count();
+  if (n == 0) return;
+  int64_t now = monotonicMs();
+  uint32_t stagger = samplePeriodMs(sampleMode) / n;
+  for (uint8_t i = 0; i < n; ++i) {
+    if (sensors[i].ok) sensors[i].configAtMs = now + (int64_t)i * stagger;
+  }
+  applyDueConfigs(now);
+}
 
-  lastUpdate = 0;
+void applyDueConfigs(int64_t now) {
+  for (uint8_t i = 0; i < sensors.count(); ++i) {
+    SensorSlot &s = sensors[i];
+    if (s.configAtMs < 0 || now < s.configAtMs) continue;
+    s.configAtMs = -1;
+    applySubscription(i);
+  }
+}
+
+// 采集任务中调用: 以新速率重新订阅当前输出 (不重新 begin), BSEC 状态与已学习的基线保留。
+// 先在第一个传感器上切换, BSEC 拒绝时全部保持原模式; 其余传感器随后按错开的相位依次切换
+bool setSampleMode(SampleMode mode) {
+  if (mode >= MODE_COUNT || mode == sampleMode) return mode == sampleMode;
+  SampleMode prev = sampleMode;
+  if (sensors.count() && sensors[0].ok) {
+    SensorSlot &s = sensors[0];
+    BsecSubscription sub = bsecSubscription(s.activeMask);
+    if (sub.count && !s.bsec.updateSubscription(sub.ids, sub.count, SAMPLE_MODES[mode].rate)) {
+      acqLog("[BSEC] 切换到 %s 失败 (bsecStatus=%d), 保持 %s\n", SAMPLE_MODES[mode].name, s.bsec.status, SAMPLE_MODES[prev].name);
+      return false;
+    }
+  }
+  sampleMode = mode;
+  sampleModeStats.enter(mode, monotonicMs());
+  scheduleSensorConfig();
+  acqLog("[BSEC] 采样模式 %s -> %s (周期 %.1f s)\n", SAMPLE_MODES[prev].name, SAMPLE_MODES[mode].name, samplePeriodMs(mode) / 1000.0f);
   return true;
 }
 
+// 采集任务中调用: 在传感器 i 上开始并行模式扫描 (SCAN_OFF 停止)。扫描期间该传感器的 BSEC 暂停,
+// 停止后取消全部订阅再重新订阅, 让 BSEC 从当前时刻重新排定测量, 而不是把暂停当作一次迟到的调用
+void setGasScan(uint8_t i) {
+  if (gasScanner.active()) {
+    uint8_t prev = gasScanner.sensor();
+    gasScanner.stop();
+    SensorSlot &s = sensors[prev];
+    BsecSubscription all = bsecSubscription(s.activeMask);
+    if (all.count) s.bsec.updateSubscription(all.ids, all.count, BSEC_SAMPLE_RATE_DISABLED);
+    s.activeMask = 0;
+    s.configAtMs = monotonicMs();
+    acqLog("[扫描] 传感器 #%u 停止扫描, 恢复 BSEC\n", prev);
+  }
+  scanningSensor.store(SCAN_OFF, std::memory_order_release);
+  if (i == SCAN_OFF) return;
+  if (i >= sensors.count() || !sensors[i].ok) {
+    acqLog("[扫描] 传感器 #%u 不可用\n", i);
+    return;
+  }
+  if (fastTph.active() && fastTph.sensor() == i) {
+    fastTph.stop();
+    acqLog("[高速] 传感器 #%u 开始扫描, 停止高速温湿压\n", i);
+  }
+  if (!gasScanner.start(sensors[i].bsec.sensor, i, scanProfile, esp_timer_get_time())) {
+    acqLog("[扫描] 传感器 #%u 进入并行模式失败 (bmeStatus=%d)\n", i, sensors[i].bsec.sensor.status);
+    sensors[i].configAtMs = monotonicMs();
+    return;
+  }
+  scanningSensor.store(i, std::memory_order_release);
+  sampleModeStats.subscribe(i, MODE_COUNT, monotonicMs()); // 扫描期间 BSEC 暂停, 停止后重新订阅
+  acqLog("[扫描] 传感器 #%u 进入并行模式, %u 步, 每轮 %.2f s\n", i, scanProfile.len, gasScanner.cycleMs() / 1000.0f);
+}
+
+// 采集任务: 开始/停止高速温湿压 (i = SCAN_OFF 停止); 正在加热曲线扫描的传感器不能同时使用
+void setFastTph(uint8_t i, uint16_t hz) {
+  fastTph.stop();
+  if (i == SCAN_OFF) {
+    acqLog("[高速] 已停止\n");
+    return;
+  }
+  if (i >= sensors.count() || !sensors[i].ok || (gasScanner.active() && gasScanner.sensor() == i)) {
+    acqLog("[高速] 传感器 #%u 不可用 (未初始化或正在扫描)\n", i);
+    return;
+  }
+  if (!fastTph.start(sensors[i].bsec.sensor, i, hz, esp_timer_get_time())) {
+    acqLog("[高速] 传感器 #%u 启动失败 (bmeStatus=%d)\n", i, sensors[i].bsec.sensor.status);
+    return;
+  }
+  acqLog("[高速] 传感器 #%u, %.1f Hz, 加热器关闭\n", i, fastTph.hz());
+}
+
+// 任意任务可调用: 交给采集任务切换采样模式
+void requestSampleMode(SampleMode mode) {
+  requestedSampleMode.store(mode, std::memory_order_release);
+  requestAcquisition(ACQ_REQ_SAMPLE_MODE);
+}
+
+// BSEC 每处理一帧原始数据回调一次; 所有输出共享同一个输入时间戳
+// 回调不带实例信息, 由 runSensor() 设置的 currentSensor 确定来源; 原始帧录制只覆盖第一个传感器
+void onBsecOutputs(const bme68xData data, const bsecOutputs outputs, const Bsec2 /*bsec*/) {
+  if (outputs.nOutputs == 0) return;
+  SensorSlot &s = sensors[currentSensor];
+  ++s.outputCount;
+  s.lastOutputTsMs = outputs.output[0].time_stamp / 1000000LL;
+  uint32_t t0 = StageTimers::now();
+  applyBsecOutputs(outputs, s.values);
+  stageTimers.end(STAGE_PARSE_OUTPUTS, t0);
+  s.pacer.onOutput(s.lastOutputTsMs);
+  if (currentSensor == 0) rawRecorder.record(outputs.output[0].time_stamp, data);
+}
+
+// 串口命令: 按行读取, 回车结束
+void pollSerialCommands() {
+  static char line[128];
+  static uint8_t len = 0;
+  while (Serial.available()) {
+    int c = Serial.read();
+    if (c == '\r') continue;
+    if (c == '\n') {
+      line[len] = '\0';
+      if (len) handleSerialCommand(line);
+      len = 0;
+    } else if (len < sizeof(line) - 1) {
+      line[len++] = (char)c;
+    }
+  }
+}
+
+void handleSerialCommand(const char *cmd) {
+  if (strcmp(cmd, "timing") == 0) {
+    stageTimers.print();
+    printLoopDuty();
+  } else if (strcmp(cmd, "timing reset") == 0) {
+    stageTimers.reset(~ACQ_STAGES); // 采集任务的阶段与定时任务统计由它自己清零
+    loopWakeups = 0;
+    loopBusyUs = 0;
+    loopStatsSinceUs = esp_timer_get_time();
+    requestAcquisition(ACQ_REQ_RESET_TIMING);
+    Serial.println("[命令] 阶段计时已清零");
+  } else if (strcmp(cmd, "jobs") == 0) {
+    requestAcquisition(ACQ_REQ_PRINT_JOBS);
+  } else if (strcmp(cmd, "stats") == 0) {
+    printSampleStats();
+  } else if (strcmp(cmd, "rate") == 0) {
+    rateController.print();
+    requestAcquisition(ACQ_REQ_PRINT_RATE);
+  } else if (strcmp(cmd, "rate auto") == 0 || strcmp(cmd, "rate auto off") == 0) {
+    bool on = cmd[9] == '\0';
+    setAutoRate(on);
+    Serial.printf("[命令] 自适应采样率已%s\n", on ? "开启" : "关闭");
+  } else if (strcmp(cmd, "rate reset") == 0) {
+    requestAcquisition(ACQ_REQ_RESET_RATE);
+    Serial.println("[命令] 采样模式统计已清零");
+  } else if (strncmp(cmd, "rate ", 5) == 0) {
+    SampleMode mode = sampleModeByName(cmd + 5);
+    if (mode == MODE_COUNT) {
+      Serial.printf("[命令] 未知采样模式: %s (可用: ulp, lp, cont, scan)\n", cmd + 5);
+    } else {
+      if (rateController.isEnabled()) {
+        setAutoRate(false);
+        Serial.println("[命令] 手动指定模式, 自适应采样率已关闭");
+      }
+      requestSampleMode(mode);
+    }
+  } else if (strcmp(cmd, "sensors") == 0) {
+    requestAcquisition(ACQ_REQ_PRINT_SENSORS);
+  } else if (strncmp(cmd, "sensor ", 7) == 0) {
+    int n = atoi(cmd + 7);
+    if (n < 0 || n >= sensorTable.count) {
+      Serial.printf("[命令] 传感器序号超出范围: %s (共 %u 个)\n", cmd + 7, sensorTable.count);
+    } else {
+      uiSensor = (uint8_t)n;
+      requestAcquisition(ACQ_REQ_REFRESH);
+      Serial.printf("[命令] 显示传感器 #%d\n", n);
+    }
+  } else if (strcmp(cmd, "scan") == 0) {
+    requestAcquisition(ACQ_REQ_PRINT_SCAN);
+  } else if (strcmp(cmd, "scan start") == 0 || strncmp(cmd, "scan start ", 11) == 0) {
+    int n = cmd[10] ? atoi(cmd + 11) : uiSensor;
+    if (n < 0 || n >= sensorTable.count) {
+      Serial.printf("[命令] 传感器序号超出范围: %d (共 %u 个)\n", n, sensorTable.count);
+    } else {
+      printScanHeader();
+      requestedScanSensor.store((uint8_t)n, std::memory_order_release);
+      requestAcquisition(ACQ_REQ_GAS_SCAN);
+    }
+  } else if (strcmp(cmd, "scan stop") == 0) {
+    requestedScanSensor.store(SCAN_OFF, std::memory_order_release);
+    requestAcquisition(ACQ_REQ_GAS_SCAN);
+  } else if (strncmp(cmd, "scan profile ", 13) == 0 || strncmp(cmd, "scan base ", 10) == 0) {
+    // 采集任务只在开始扫描时读取曲线, 运行中不允许修改
+    if (scanningSensor.load(std::memory_order_acquire) != SCAN_OFF) {
+      Serial.println("[命令] 请先 scan stop 再修改加热曲线");
+    } else if (cmd[5] == 'p' && !parseHeaterProfile(cmd + 13, scanProfile)) {
+      Serial.printf("[命令] 加热曲线格式错误: %s (示例: 320x5,100x2,200x5, 最多 %u 步, 100-400 °C)\n", cmd + 13, SCAN_MAX_STEPS);
+    } else {
+      if (cmd[5] == 'b') scanProfile.baseMs = (uint16_t)atoi(cmd + 10);
+      requestAcquisition(ACQ_REQ_PRINT_SCAN);
+    }
+  } else if (strcmp(cmd, "scan label") == 0 || strncmp(cmd, "scan label ", 11) == 0) {
+    snprintf(scanLabel, sizeof(scanLabel), "%s", cmd[10] ? cmd + 11 : "");
+    for (char *c = scanLabel; *c; ++c) if (*c == ',') *c = '_'; // 标签是 CSV 的一列
+    Serial.printf("[命令] 扫描标签: %s\n", scanLabel[0] ? scanLabel : "(无)");
+#if defined(USE_BSEC2)
+  } else if (strcmp(cmd, "config") == 0) {
+    runConfigOp(CONFIG_LIST, "");
+  } else if (strncmp(cmd, "config install ", 15) == 0) {
+    runConfigOp(CONFIG_INSTALL, cmd + 15);
+  } else if (strncmp(cmd, "config remove ", 14) == 0) {
+    runConfigOp(CONFIG_REMOVE, cmd + 14);
+  } else if (strncmp(cmd, "config ", 7) == 0) {
+    runConfigOp(CONFIG_SELECT, cmd + 7);
+#endif
+  } else if (strcmp(cmd, "voc") == 0) {
+    printVocBaselines();
+  } else if (strcmp(cmd, "voc reset") == 0) {
+    // 下一个样本以当前阻值重新建立基线; 应在洁净空气中执行
+    vocBaselines[uiSensor].clear();
+    vocWarmStart[uiSensor] = false;
+    char key[16], ns[16];
+    vocKey(uiSensor, key, sizeof(key));
+    stateNamespace(bsecConfigCrc.load(std::memory_order_acquire), ns, sizeof(ns));
+    Preferences prefs;
+    prefs.begin(ns, false);
+    prefs.remove(key);
+    prefs.end();
+    Serial.printf("[简易VOC] #%u 基线已清除, 将以下一个样本重新建立\n", uiSensor);
+  } else if (strcmp(cmd, "events") == 0) {
+    printEvents();
+  } else if (strcmp(cmd, "rollup") == 0) {
+    printRollups();
+  } else if (strncmp(cmd, "rollup ", 7) == 0) {
+    uint8_t l = 0;
+    while (l < ROLLUP_LEVEL_COUNT && strcmp(ROLLUP_LEVELS[l].name, cmd + 7) != 0) ++l;
+    if (l == ROLLUP_LEVEL_COUNT) {
+      Serial.printf("[命令] 用法: rollup [1m|1h|24h]: %s\n", cmd + 7);
+    } else {
+      printRollupBuckets(l);
+    }
+  } else if (strcmp(cmd, "history") == 0) {
+    printHistory();
+  } else if (strncmp(cmd, "history ", 8) == 0) {
+    long minutes = atol(cmd + 8);
+    if (minutes < 1) {
+      Serial.printf("[命令] 用法: history [分钟]: %s\n", cmd + 8);
+    } else {
+      exportHistory((uint32_t)minutes);
+    }
+  } else if (strcmp(cmd, "log") == 0) {
+    printFlashLog();
+  } else if (strcmp(cmd, "log dump") == 0) {
+    dumpFlashLog();
+  } else if (strcmp(cmd, "mark") == 0) {
+    if (!rawRecorder.active()) {
+      Serial.println("[命令] 没有在录制, 标记不会保存");
+    } else {
+      requestAcquisition(ACQ_REQ_MARK);
+      Serial.printf("[命令] 已在录制文件中写入标记 (%lld ms)\n", (long long)monotonicMs());
+    }
+  } else if (strcmp(cmd, "window") == 0) {
+    printRolling();
+  } else if (strncmp(cmd, "window ", 7) == 0) {
+    char name[16];
+    long sec = 0;
+    uint8_t f = ROLLING_FIELD_COUNT;
+    if (sscanf(cmd + 7, "%15s %ld", name, &sec) == 2) {
+      for (f = 0; f < ROLLING_FIELD_COUNT && strcmp(ROLLING_FIELDS[f].name, name) != 0; ++f) {}
+    }
+    if (f == ROLLING_FIELD_COUNT || sec < 1 || sec > 7L * 24L * 3600L) {
+      Serial.printf("[命令] 用法: window <gas|temp|hum|pressure> <1-604800 秒>: %s\n", cmd + 7);
+    } else {
+      setRollingWindow(f, (uint32_t)sec * 1000UL);
+      Serial.printf("[命令] %s 窗口改为 %ld s, 重新开始统计\n", ROLLING_FIELDS[f].name, sec);
+    }
+  } else if (strcmp(cmd, "fast") == 0) {
+    requestAcquisition(ACQ_REQ_PRINT_FAST);
+  } else if (strcmp(cmd, "fast off") == 0) {
+    requestedFastSensor.store(SCAN_OFF, std::memory_order_release);
+    requestAcquisition(ACQ_REQ_FAST_TPH);
+  } else if (strcmp(cmd, "fast log") == 0) {
+    fastLog = !fastLog;
+    if (fastLog) Serial.println("fast,传感器,时间ms,温度,湿度,气压hPa");
+    Serial.printf("[命令] 高速样本输出已%s\n", fastLog ? "开启" : "关闭");
+  } else if (strncmp(cmd, "fast ", 5) == 0) {
+    char *end;
+    long hz = strtol(cmd + 5, &end, 10);
+    int n = *end == ' ' ? atoi(end + 1) : uiSensor;
+    if (hz < 1 || hz > FAST_TPH_MAX_HZ || (*end != ' ' && *end != '\0')) {
+      Serial.printf("[命令] 频率应为 1-%u Hz: %s\n", FAST_TPH_MAX_HZ, cmd + 5);
+    } else if (n < 0 || n >= sensorTable.count) {
+      Serial.printf("[命令] 传感器序号超出范围: %d (共 %u 个)\n", n, sensorTable.count);
+    } else {
+      requestedFastHz.store((uint16_t)hz, std::memory_order_release);
+      requestedFastSensor.store((uint8_t)n, std::memory_order_release);
+      requestAcquisition(ACQ_REQ_FAST_TPH);
+    }
+  } else if (strcmp(cmd, "subs") == 0) {
+    requestAcquisition(ACQ_REQ_PRINT_SUBS);
+  } else if (strncmp(cmd, "subs off ", 9) == 0 || strncmp(cmd, "subs on ", 8) == 0) {
+    // 调试用: 暂停/恢复某个消费者的需求, 观察订阅与 BSEC 耗时变化
+    bool off = cmd[6] == 'f';
+    const char *name = cmd + (off ? 9 : 8);
+    int8_t id = bsecConsumers.find(name);
+    if (id < 0) {
+      Serial.printf("[命令] 未知消费者: %s\n", name);
+    } else {
+      bsecConsumers.pause(id, off);
+      requestAcquisition(0); // 唤醒采集任务尽快重新订阅
+      Serial.printf("[命令] 消费者 %s 已%s\n", name, off ? "暂停" : "恢复");
+    }
+  } else {
+    Serial.printf("[命令] 未知命令: %s (可用: timing, timing reset, jobs, stats, rate, rate <模式>, rate auto [off], rate reset, sensors, sensor <n>, scan, scan start [n]|stop, scan profile <曲线>, scan base <ms>, scan label [名称], fast, fast <Hz> [n]|off|log, voc, voc reset, events, mark, rollup [1m|1h|24h], history [分钟], log, log dump, window [通道 秒], " CONFIG_COMMANDS "subs, subs off|on <名称>)\n", cmd);
+  }
+}
+
 float calcAltitude(float pressure_hPa) {
   return 44330.0f * (1.0f - pow(pressure_hPa / gSeaLevelPressure, 0.1903f));
 }
@@ -291,12 +1692,12 @@ void updateDynamicUI(const SensorValues &vals) {
   M5.Display.setFont(&efontCN_12);
   M5.Display.setTextColor(TFT_WHITE, TFT_BLACK);
   M5.Display.setCursor(regionTemp.x+12, regionTemp.y+5);
-  M5.Display.printf("%5.2f °C", vals.temperature);
+  M5.Display.printf("%5.2f °C", vals.compTemperature);
 
   // Humidity
   updateRegion(regionHum);
   M5.Display.setCursor(regionHum.x+12, regionHum.y+5);
-  M5.Display.printf("%5.2f %%", vals.humidity);
+  M5.Display.printf("%5.2f %%", vals.compHumidity);
 
   // Pressure
   updateRegion(regionPress);
@@ -333,39 +1734,155 @@ void updateDynamicUI(const SensorValues &vals) {
   }
 }
 
-void i2cScan() {
-  Serial.println("=== I2C 设备扫描 ===");
-  uint8_t count = 0;
-  for (uint8_t addr = 1; addr < 127; ++addr) {
-    Wire.beginTransmission(addr);
-    if (Wire.endTransmission() == 0) {
-      Serial.printf("发现 I2C 设备于地址 0x%02X\n", addr);
-      ++count;
-    }
+// 每个配置学到的状态互不通用, 各自保存在一个命名空间下 (NVS 命名空间最长 15 个字符)
+void stateNamespace(uint32_t configCrc, char *ns, size_t len) {
+  if (configCrc == 0) {
+    snprintf(ns, len, "%s", PREF_NAMESPACE);
+  } else {
+    snprintf(ns, len, "%s_%08x", PREF_NAMESPACE, (unsigned)configCrc);
   }
-  Serial.printf("扫描完成, 共发现 %u 个设备\n", count);
-  Serial.println("==================");
 }
 
-void loadState() {
+#if defined(USE_BSEC2)
+// 启动时恢复上次选择的配置, 并在采集任务使用前准备好 (未安装时从文件安装)
+void loadConfigSelection() {
+  Preferences prefs;
   prefs.begin(PREF_NAMESPACE, true);
-  size_t len = prefs.getBytesLength(PREF_KEY_STATE);
+  if (!prefs.getString("config", bsecConfigName, sizeof(bsecConfigName))) {
+    snprintf(bsecConfigName, sizeof(bsecConfigName), "%s", BSEC_CONFIG_DEFAULT);
+  }
+  prefs.end();
+  if (strcmp(bsecConfigName, BSEC_CONFIG_DEFAULT) != 0) bsecConfigs.prepare(bsecConfigName, nullptr); // 失败时 initBsec2() 退回默认配置
+}
+
+// 采集任务: 热切换 BSEC 配置 (loop() 已安装到槽位或读入 RAM)。先取出当前状态 (落盘到旧配置的命名空间),
+// 再以新配置重建所有实例并加载其名下的状态; 新配置缺失或被 BSEC 拒绝时回到原配置
+void selectConfig(const char *name) {
+  uint32_t crc;
+  if (strcmp(name, BSEC_CONFIG_DEFAULT) != 0 && !bsecConfigs.acquire(name, crc)) {
+    acqLog("[配置] 没有可用的 %s, 保持 %s\n", name, bsecConfigName); // 缺失/损坏时不必重建实例
+    return;
+  }
+  for (uint8_t i = 0; i < sensors.count(); ++i) {
+    if (sensors[i].ok && sensors[i].values.iaqAccuracy == 3) captureState(i);
+  }
+  char prev[sizeof(bsecConfigName)];
+  snprintf(prev, sizeof(prev), "%s", bsecConfigName);
+  snprintf(bsecConfigName, sizeof(bsecConfigName), "%s", name);
+  initBsec2();
+  if (strcmp(bsecConfigName, name) != 0) {
+    acqLog("[配置] 切换到 %s 失败, 恢复 %s\n", name, prev);
+    snprintf(bsecConfigName, sizeof(bsecConfigName), "%s", prev);
+    initBsec2();
+    return;
+  }
+  // 选择与状态同在 NVS 中, 交给 loop() 写入 (NVS 写入都在 loop() 中)
+  snprintf(savedConfigName, sizeof(savedConfigName), "%s", bsecConfigName);
+  configSaveDue.store(true, std::memory_order_release);
+}
+
+// loop(): 保存切换后的配置选择
+void saveConfigSelection() {
+  Preferences prefs;
+  prefs.begin(PREF_NAMESPACE, false);
+  prefs.putString("config", savedConfigName);
+  prefs.end();
+  configSaveDue.store(false, std::memory_order_release);
+}
+
+// loop(): 列出/安装/删除直接在这里读写文件与 flash (可能耗时数十毫秒, 不占用采集任务)。
+// 采集任务重建实例时会读取槽位/缓冲, 重建完成且 loop() 取用新传感器表之前不改动配置仓库
+void runConfigOp(ConfigOp op, const char *name) {
+  if (strlen(name) >= sizeof(configArg)) {
+    Serial.printf("[命令] 配置名最长 %u 个字符\n", (unsigned)sizeof(configArg) - 1);
+    return;
+  }
+  if (op != CONFIG_LIST && (rebuildPending.load(std::memory_order_acquire) || sensorsReinitDue.load(std::memory_order_acquire) ||
+                            configSaveDue.load(std::memory_order_acquire))) {
+    Serial.println("[命令] 上一个配置操作尚未完成");
+    return;
+  }
+  switch (op) {
+  case CONFIG_LIST:
+    bsecConfigs.print(activeConfigName);
+    break;
+  case CONFIG_SELECT:
+    requestConfigSelect(name);
+    break;
+  case CONFIG_INSTALL:
+    // 重新安装当前配置会覆盖其槽位: 重新加载, 使 BSEC 用上新内容
+    if (bsecConfigs.install(name) >= 0 && strcmp(name, activeConfigName) == 0) requestConfigSelect(name);
+    break;
+  case CONFIG_REMOVE:
+    if (strcmp(name, activeConfigName) == 0) {
+      Serial.println("[配置] 不能删除正在使用的配置");
+    } else {
+      Serial.printf("[配置] %s %s\n", name, bsecConfigs.remove(name) ? "已删除" : "不在槽位中");
+    }
+    break;
+  }
+}
+
+// loop(): 准备好配置 (未安装时从文件安装) 后交给采集任务重建实例; 缺失/损坏时不打扰采集任务
+void requestConfigSelect(const char *name) {
+  if (strcmp(name, BSEC_CONFIG_DEFAULT) != 0 && !bsecConfigs.prepare(name, activeConfigName)) {
+    Serial.printf("[配置] 没有可用的 %s, 保持 %s\n", name, activeConfigName);
+    return;
+  }
+  snprintf(configArg, sizeof(configArg), "%s", name);
+  rebuildPending.store(true, std::memory_order_release);
+  requestAcquisition(ACQ_REQ_CONFIG);
+}
+#endif
+
+void loadState(uint8_t i) {
+  char key[16], ns[16];
+  sensors.stateKey(i, key, sizeof(key));
+  stateNamespace(bsecConfigCrc.load(std::memory_order_acquire), ns, sizeof(ns));
+  Preferences prefs; // 采集任务中调用, 与 loop() 的 NVS 访问互不干扰
+  prefs.begin(ns, true);
+  size_t len = prefs.getBytesLength(key);
   if (len > 0 && len <= BSEC_MAX_STATE_BLOB_SIZE) {
     uint8_t blob[BSEC_MAX_STATE_BLOB_SIZE];
-    prefs.getBytes(PREF_KEY_STATE, blob, len);
-    if (envSensor.setState(blob)) {
-      Serial.println("已加载 BSEC2 状态");
+    prefs.getBytes(key, blob, len);
+    if (sensors[i].bsec.setState(blob)) {
+      acqLog("已加载 BSEC2 状态 (#%u, %s)\n", i, key);
     }
   }
   prefs.end();
 }
 
+// 采集任务: 取出传感器 i 的 BSEC 状态放入交接缓冲; 上一份尚未落盘时返回 false
+bool captureState(uint8_t i) {
+  uint16_t bit = 1u << i;
+  if (pendingStateMask.load(std::memory_order_acquire) & bit) return false;
+  if (!sensors[i].bsec.getState(pendingStateBlobs[i])) return false;
+  pendingStateConfig[i] = bsecConfigCrc.load(std::memory_order_acquire);
+  sensors.stateKey(i, pendingStateKey[i], sizeof(pendingStateKey[i]));
+  pendingStateMask.fetch_or(bit, std::memory_order_release);
+  return true;
+}
+
+// loop(): 把交接缓冲中的状态写入 NVS, 每个传感器一个键, 按取出时的配置分命名空间
 void saveState() {
-  uint8_t blob[BSEC_MAX_STATE_BLOB_SIZE];
-  if (envSensor.getState(blob)) {
-    prefs.begin(PREF_NAMESPACE, false);
-    prefs.putBytes(PREF_KEY_STATE, blob, BSEC_MAX_STATE_BLOB_SIZE);
-    prefs.end();
-    Serial.println("已保存 BSEC2 状态");
+  uint16_t mask = pendingStateMask.load(std::memory_order_acquire);
+  uint8_t saved = 0;
+  Preferences prefs;
+  char openNs[16] = "";
+  for (uint8_t i = 0; i < MAX_SENSORS; ++i) {
+    if (!(mask & (1u << i))) continue;
+    char ns[16];
+    stateNamespace(pendingStateConfig[i], ns, sizeof(ns));
+    if (strcmp(ns, openNs) != 0) {
+      if (openNs[0]) prefs.end();
+      prefs.begin(ns, false);
+      snprintf(openNs, sizeof(openNs), "%s", ns);
+    }
+    prefs.putBytes(pendingStateKey[i], pendingStateBlobs[i], BSEC_MAX_STATE_BLOB_SIZE);
+    putVocBaseline(prefs, i);
+    ++saved;
   }
+  if (openNs[0]) prefs.end();
+  pendingStateMask.fetch_and((uint16_t)~mask, std::memory_order_release);
+  Serial.printf("已保存 BSEC2 状态 (%u 个传感器)\n", saved);
 }
@@ -0,0 +1,101 @@
+#include "rate_controller.h"
+
+// 变化速率阈值 (每分钟); score = 各项 |速率| / 阈值 的最大值
+static const float IAQ_RATE_FAST = 15.0f;      // IAQ 点/分钟
+static const float GAS_RATE_FAST = 5.0f;       // 气体阻值 %/分钟
+static const float VOC_RATE_FAST = 6.0f;       // 简易 VOC 指数 点/分钟
+static const float SCORE_ENTER_FAST = 1.0f;
+static const float SCORE_CALM = 0.3f;          // 低于此值视为平稳
+static const int64_t CALM_HOLD_MS = 15LL * 60LL * 1000LL;   // 连续平稳多久后降速
+static const int64_t MIN_FAST_MS = 15LL * 60LL * 1000LL;    // 快速模式最短停留
+static const int64_t PENDING_TIMEOUT_MS = 10LL * 60LL * 1000LL; // 请求的切换迟迟未生效 (被 BSEC 拒绝) 时放弃等待
+static const float LEVEL_TAU_MIN = 1.0f;
+static const float SLOPE_TAU_MIN = 2.0f;
+
+void RateController::Trend::update(float x, float dtMin) {
+  if (isnan(x)) return;
+  if (isnan(level)) {
+    level = x;
+    slope = 0.0f;
+    return;
+  }
+  float prev = level;
+  level += (1.0f - expf(-dtMin / LEVEL_TAU_MIN)) * (x - level);
+  float inst = (level - prev) / dtMin;
+  slope += (1.0f - expf(-dtMin / SLOPE_TAU_MIN)) * (inst - slope);
+}
+
+void RateController::Channel::update(const SensorValues &vals) {
+  int64_t ts = vals.timestampMs;
+  if (lastTsMs >= 0 && ts > lastTsMs) {
+    float dtMin = (ts - lastTsMs) / 60000.0f;
+    iaq.update(vals.iaq, dtMin);
+    gas.update(vals.gas_kOhm, dtMin);
+    voc.update(vals.simpleVocIndex, dtMin);
+  } else if (lastTsMs < 0) {
+    iaq.update(vals.iaq, 1.0f);
+    gas.update(vals.gas_kOhm, 1.0f);
+    voc.update(vals.simpleVocIndex, 1.0f);
+  }
+  lastTsMs = ts;
+  periodMs = vals.periodMs;
+  score = fabsf(iaq.slope) / IAQ_RATE_FAST;
+  if (!isnan(gas.level) && gas.level > 0) score = fmaxf(score, fabsf(gas.slope) / gas.level * 100.0f / GAS_RATE_FAST);
+  score = fmaxf(score, fabsf(voc.slope) / VOC_RATE_FAST);
+}
+
+void RateController::Channel::print(uint8_t i) const {
+  Serial.printf("  #%u IAQ %.2f/min, 气体 %.2f%%/min, 简易VOC %.2f/min (score=%.2f)\n", i, iaq.slope,
+                (!isnan(gas.level) && gas.level > 0) ? gas.slope / gas.level * 100.0f : 0.0f, voc.slope, score);
+}
+
+// 采样模式切换在各传感器上错开生效: 所有有数据的传感器都以该周期出样本, 才算切换完成
+bool RateController::allAt(uint32_t periodMs) const {
+  for (uint8_t i = 0; i < MAX_SENSORS; ++i) {
+    if (channels[i].lastTsMs >= 0 && channels[i].periodMs != periodMs) return false;
+  }
+  return true;
+}
+
+SampleMode RateController::onSample(const SensorValues &vals) {
+  int64_t ts = vals.timestampMs;
+  if (vals.sensor >= MAX_SENSORS) return MODE_COUNT;
+  channels[vals.sensor].update(vals);
+  lastScore = 0.0f;
+  for (uint8_t i = 0; i < MAX_SENSORS; ++i) lastScore = fmaxf(lastScore, channels[i].score);
+
+  if (lastScore >= SCORE_CALM) calmSinceMs = -1;
+  else if (calmSinceMs < 0) calmSinceMs = ts;
+  if (!enabled) return MODE_COUNT;
+  if (pending != MODE_COUNT) {
+    if (!allAt(samplePeriodMs(pending)) && ts - pendingSinceMs < PENDING_TIMEOUT_MS) return MODE_COUNT;
+    pending = MODE_COUNT;
+  }
+
+  bool inFast = allAt(samplePeriodMs(fastMode));
+  if (!inFast) {
+    if (lastScore < SCORE_ENTER_FAST) return MODE_COUNT;
+    fastSinceMs = ts;
+    ++switches;
+    Serial.printf("[自适应] 变化速率 %.2f, 切到 %s\n", lastScore, SAMPLE_MODES[fastMode].name);
+    pending = fastMode;
+    pendingSinceMs = ts;
+    return fastMode;
+  }
+  if (fastSinceMs < 0) fastSinceMs = ts; // 手动或启动时已处于快速模式
+  if (calmSinceMs < 0 || ts - calmSinceMs < CALM_HOLD_MS || ts - fastSinceMs < MIN_FAST_MS) return MODE_COUNT;
+  fastSinceMs = -1;
+  ++switches;
+  Serial.printf("[自适应] 已平稳 %lld min, 切到 %s\n", (long long)((ts - calmSinceMs) / 60000), SAMPLE_MODES[slowMode].name);
+  pending = slowMode;
+  pendingSinceMs = ts;
+  return slowMode;
+}
+
+void RateController::print() const {
+  Serial.printf("[自适应] %s, score=%.2f (进入快速 >= %.1f, 平稳 < %.1f), 切换 %u 次\n", enabled ? "开启" : "关闭", lastScore,
+                SCORE_ENTER_FAST, SCORE_CALM, switches);
+  for (uint8_t i = 0; i < MAX_SENSORS; ++i) {
+    if (channels[i].lastTsMs >= 0) channels[i].print(i);
+  }
+}
@@ -0,0 +1,50 @@
+#pragma once
+// 自适应采样率控制: 跟踪 IAQ、气体阻值与简易 VOC 指数的变化速率, 空气有变化时切到快速模式 (LP),
+// 持续平稳后回到 ULP。带滞回: 进入快速模式的阈值高于退出阈值, 且退出前要求连续平稳并在快速模式停留足够久,
+// 避免在两种模式之间来回抖动。每个样本在 loop() 的数据管线中调用一次 onSample()。
+// 多传感器时每个传感器单独跟踪变化速率, 任一传感器变化快即进入快速模式, 全部平稳才降速 (采样模式全局共用)。
+#include <Arduino.h>
+#include "sensor_values.h"
+#include "sensor_array.h"
+#include "sample_mode.h"
+
+class RateController {
+public:
+  void setEnabled(bool on) { enabled = on; }
+  bool isEnabled() const { return enabled; }
+
+  // 返回希望切换到的模式; 不需要切换时返回 MODE_COUNT
+  SampleMode onSample(const SensorValues &vals);
+  void print() const;
+
+  SampleMode fastMode = MODE_LP;
+  SampleMode slowMode = MODE_ULP;
+
+private:
+  // 变化速率: 先以 LEVEL_TAU 平滑数值, 再以 SLOPE_TAU 平滑其每分钟变化量, 压住单次测量噪声
+  struct Trend {
+    float level = NAN;
+    float slope = 0.0f; // 每分钟
+    void update(float x, float dtMin);
+  };
+
+  struct Channel {
+    Trend iaq, gas, voc;
+    int64_t lastTsMs = -1;
+    uint32_t periodMs = 0;  // 最近样本的采样周期
+    float score = 0.0f;
+    void update(const SensorValues &vals);
+    void print(uint8_t i) const;
+  };
+
+  bool allAt(uint32_t periodMs) const;
+
+  bool enabled = false;
+  Channel channels[MAX_SENSORS];
+  SampleMode pending = MODE_COUNT; // 已请求、尚未在样本上生效的模式
+  int64_t pendingSinceMs = -1;
+  int64_t fastSinceMs = -1;   // 进入快速模式的时刻
+  int64_t calmSinceMs = -1;   // 本轮连续平稳的起点
+  float lastScore = 0.0f;        // 各传感器 score 的最大值
+  uint32_t switches = 0;
+};
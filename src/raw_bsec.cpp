@@ -0,0 +1,107 @@
+#include "bsec_backend.h"
+
+#if !defined(USE_BSEC2)
+
+static const uint16_t HEATER_TEMP_C = 320;   // 与 BSEC LP/ULP 的默认加热设定相同
+static const uint16_t HEATER_DUR_MS = 197;
+
+bool Bsec2::begin(uint8_t i2cAddr, TwoWire &i2c, bme68x_delay_us_fptr_t idleTask) {
+  sensor.begin(i2cAddr, i2c, idleTask);
+  return reset();
+}
+
+bool Bsec2::begin(bme68xIntf intf, bme68x_read_fptr_t read, bme68x_write_fptr_t write, bme68x_delay_us_fptr_t idleTask, void *intfPtr) {
+  sensor.begin(intf, read, write, idleTask, intfPtr);
+  return reset();
+}
+
+bool Bsec2::reset() {
+  status = BSEC_OK;
+  if (sensor.checkStatus() == BME68X_ERROR) return false;
+  outputs = {};
+  subscribed = 0;
+  periodNs = 0;
+  return true;
+}
+
+bool Bsec2::updateSubscription(bsecSensor sensorList[], uint8_t nSensors, float sampleRate) {
+  if (sampleRate != BSEC_SAMPLE_RATE_ULP && sampleRate != BSEC_SAMPLE_RATE_LP &&
+      sampleRate != BSEC_SAMPLE_RATE_CONT && sampleRate != BSEC_SAMPLE_RATE_SCAN &&
+      sampleRate != BSEC_SAMPLE_RATE_DISABLED) {
+    status = BSEC_E_SU_SAMPLERATELIMITS;
+    return false;
+  }
+  for (uint8_t i = 0; i < nSensors; ++i) {
+    uint32_t bit = 1UL << sensorList[i];
+    if (sampleRate == BSEC_SAMPLE_RATE_DISABLED) {
+      subscribed &= ~bit;
+    } else {
+      subscribed |= bit;
+    }
+  }
+  // 周期与 BSEC 构建一致 (samplePeriodMs() 同样按 1000 / rate 取整), 改变周期时从现在开始重新计时
+  int64_t newPeriod = sampleRate == BSEC_SAMPLE_RATE_DISABLED ? periodNs : (int64_t)llroundf(1000.0f / sampleRate) * 1000000LL;
+  if (subscribed == 0) newPeriod = 0;
+  if (newPeriod != periodNs) nextCallNs = getTimeMs() * 1000000LL;
+  periodNs = newPeriod;
+  status = BSEC_OK;
+  return true;
+}
+
+bool Bsec2::run() {
+  int64_t currTimeNs = getTimeMs() * 1000000LL;
+  if (periodNs == 0 || currTimeNs < nextCallNs) return true;
+  nextCallNs += periodNs;
+  if (nextCallNs <= currTimeNs) nextCallNs = currTimeNs + periodNs;
+
+  sensor.setTPH(BME68X_OS_2X, BME68X_OS_1X, BME68X_OS_1X);
+  sensor.setHeaterProf(HEATER_TEMP_C, HEATER_DUR_MS);
+  sensor.setOpMode(BME68X_FORCED_MODE);
+  if (sensor.checkStatus() == BME68X_ERROR) return false;
+  delay((sensor.getMeasDur(BME68X_FORCED_MODE) + 999) / 1000 + HEATER_DUR_MS);
+
+  bme68xData data;
+  if (sensor.fetchData()) {
+    sensor.getData(data);
+    if (data.status & BME68X_GASM_VALID_MSK) processData(currTimeNs, data);
+  }
+  return true;
+}
+
+void Bsec2::processData(int64_t currTimeNs, const bme68xData &data) {
+  // 加热补偿: 与 BSEC 相同, 温度减去自热偏移, 相对湿度按新旧温度下的饱和水汽压换算
+  float compT = data.temperature - extTempOffset;
+  auto magnus = [](float t) { return expf(17.62f * t / (243.12f + t)); };
+  float compH = data.humidity * magnus(data.temperature) / magnus(compT);
+  if (compH > 100.0f) compH = 100.0f;
+
+  outputs.nOutputs = 0;
+  for (uint8_t id = 0; id < 32; ++id) {
+    if (!(subscribed >> id & 1)) continue;
+    float signal;
+    switch (id) {
+      case BSEC_OUTPUT_RAW_TEMPERATURE: signal = data.temperature; break;
+      case BSEC_OUTPUT_RAW_PRESSURE: signal = data.pressure; break;
+      case BSEC_OUTPUT_RAW_HUMIDITY: signal = data.humidity; break;
+      case BSEC_OUTPUT_RAW_GAS: signal = data.gas_resistance; break;
+      case BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_TEMPERATURE: signal = compT; break;
+      case BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_HUMIDITY: signal = compH; break;
+      default: continue; // 需要 BSEC 算法的输出
+    }
+    bsecData &o = outputs.output[outputs.nOutputs++];
+    o = {};
+    o.time_stamp = currTimeNs;
+    o.signal = signal;
+    o.sensor_id = id;
+  }
+  if (outputs.nOutputs && newDataCallback) newDataCallback(data, outputs, *this);
+}
+
+int64_t Bsec2::getTimeMs() {
+  uint32_t timeMs = millis();
+  if (lastMillis > timeMs) ++ovfCounter;
+  lastMillis = timeMs;
+  return (int64_t)timeMs + ((int64_t)ovfCounter << 32);
+}
+
+#endif
@@ -0,0 +1,98 @@
+#pragma once
+// 轻量构建 (未定义 USE_BSEC2): 不链接 BSEC 库, 通过 bme68x API 直接以 forced 模式测量。
+// 这里提供与 Bsec2 封装同名、同接口的子集, 采集循环、订阅、采样模式、多传感器与扫描代码无需区分两种构建:
+// - 按订阅的采样周期触发 forced 测量 (加热设定与 BSEC LP/ULP 相同, 阻值可与 BSEC 构建对比), 回调形式与 BSEC 相同;
+// - 只产生原始温湿压/气体阻值与加热补偿温湿度; IAQ 等输出可以订阅但永远不会出现, 精度保持 0, 界面显示简易 VOC 指数;
+// - 没有状态 blob 与配置, getState()/setState()/setConfig() 总是失败。
+#include <Arduino.h>
+#include <Wire.h>
+#include <bme68xLibrary.h>
+
+typedef int32_t bsec_library_return_t;
+#define BSEC_OK 0
+#define BSEC_E_SU_SAMPLERATELIMITS (-16)
+#define BSEC_E_CONFIG_FAIL (-32)
+
+#define BSEC_SAMPLE_RATE_DISABLED (65535.0f)
+#define BSEC_SAMPLE_RATE_ULP (0.0033333f)
+#define BSEC_SAMPLE_RATE_CONT (1.0f)
+#define BSEC_SAMPLE_RATE_LP (0.33333f)
+#define BSEC_SAMPLE_RATE_SCAN (0.055556f)
+
+#define BSEC_MAX_STATE_BLOB_SIZE (1)   // 没有状态; 只让共用的交接缓冲保持可编译
+#define BSEC_NUMBER_OUTPUTS (30)
+
+#define TEMP_OFFSET_LP (1.3255f)
+#define TEMP_OFFSET_ULP (0.466f)
+
+// 虚拟传感器 id 与 BSEC 相同, 订阅掩码与映射表在两种构建中通用
+typedef enum {
+  BSEC_OUTPUT_IAQ = 1,
+  BSEC_OUTPUT_STATIC_IAQ = 2,
+  BSEC_OUTPUT_CO2_EQUIVALENT = 3,
+  BSEC_OUTPUT_BREATH_VOC_EQUIVALENT = 4,
+  BSEC_OUTPUT_RAW_TEMPERATURE = 6,
+  BSEC_OUTPUT_RAW_PRESSURE = 7,
+  BSEC_OUTPUT_RAW_HUMIDITY = 8,
+  BSEC_OUTPUT_RAW_GAS = 9,
+  BSEC_OUTPUT_STABILIZATION_STATUS = 12,
+  BSEC_OUTPUT_RUN_IN_STATUS = 13,
+  BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_TEMPERATURE = 14,
+  BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_HUMIDITY = 15,
+  BSEC_OUTPUT_GAS_PERCENTAGE = 21,
+} bsec_virtual_sensor_t;
+
+typedef bsec_virtual_sensor_t bsecSensor;
+
+typedef struct {
+  int64_t time_stamp;
+  float signal;
+  uint8_t signal_dimensions;
+  uint8_t sensor_id;
+  uint8_t accuracy;
+} bsec_output_t;
+
+typedef bsec_output_t bsecData;
+
+typedef struct {
+  bsecData output[BSEC_NUMBER_OUTPUTS];
+  uint8_t nOutputs;
+} bsecOutputs;
+
+class Bsec2;
+typedef void (*bsecCallback)(const bme68xData data, const bsecOutputs outputs, const Bsec2 bsec);
+
+class Bsec2 {
+public:
+  Bme68x sensor;
+  bsec_library_return_t status = BSEC_OK;
+
+  bool begin(uint8_t i2cAddr, TwoWire &i2c, bme68x_delay_us_fptr_t idleTask = bme68xDelayUs);
+  bool begin(bme68xIntf intf, bme68x_read_fptr_t read, bme68x_write_fptr_t write, bme68x_delay_us_fptr_t idleTask, void *intfPtr);
+  // 增量订阅, 语义与 BSEC 相同: 以 DISABLED 速率调用即取消列出的输出
+  bool updateSubscription(bsecSensor sensorList[], uint8_t nSensors, float sampleRate = BSEC_SAMPLE_RATE_ULP);
+  // 到期时做一次 forced 测量并回调; 测量期间以 delay() 让出 CPU
+  bool run();
+  void attachCallback(bsecCallback callback) { newDataCallback = callback; }
+  bool getState(uint8_t *) { return false; }
+  bool setState(uint8_t *) { return false; }
+  bool setConfig(const uint8_t *) {
+    status = BSEC_E_CONFIG_FAIL;
+    return false;
+  }
+  void setTemperatureOffset(float tempOffset) { extTempOffset = tempOffset; }
+  int64_t getTimeMs();
+
+private:
+  bool reset();
+  void processData(int64_t currTimeNs, const bme68xData &data);
+
+  bsecCallback newDataCallback = nullptr;
+  bsecOutputs outputs{};
+  uint32_t subscribed = 0;       // 第 id 位 = 已订阅
+  int64_t periodNs = 0;
+  int64_t nextCallNs = 0;
+  float extTempOffset = 0.0f;
+  uint32_t ovfCounter = 0;
+  uint32_t lastMillis = 0;
+};
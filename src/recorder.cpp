@@ -0,0 +1,120 @@
+#include "recorder.h"
+#include <raw_record.h>
+#include <Arduino.h>
+
+RawRecorder rawRecorder;
+
+static const uint32_t FLUSH_EVERY_FRAMES = 32;
+
+bool RawRecorder::begin(const char *path, uint32_t maxBytes) {
+  end();
+  file = fopen(path, "wb");
+  if (!file) {
+    Serial.printf("[录制] 无法打开 %s\n", path);
+    return false;
+  }
+  bytes = 0;
+  limit = maxBytes;
+  frameCount = 0;
+  lost = 0;
+  droppedFrames.store(0, std::memory_order_relaxed);
+  droppedMarks.store(0, std::memory_order_relaxed);
+  reportedMarks = 0;
+  enabled.store(true, std::memory_order_release);
+  Serial.printf("[录制] 开始写入 %s (上限 %u 字节)\n", path, limit);
+  return true;
+}
+
+void RawRecorder::end() {
+  enabled.store(false, std::memory_order_release);
+  if (!file) return;
+  fclose(file);
+  file = nullptr;
+  Serial.printf("[录制] 结束, 共 %u 帧 %u 字节, 队列满丢弃 %u 帧、%u 个标记\n", frameCount, bytes, dropped(), droppedMarkers());
+}
+
+// 采集任务: 先为之前丢失的帧补一条 kDropped 记录 (时间戳取丢帧后的第一条记录); 队列仍满时返回 false
+bool RawRecorder::flushLost(int64_t timestampNs) {
+  if (lost && pending.push({rawrec::kDropped, timestampNs, {}, lost})) lost = 0;
+  return lost == 0;
+}
+
+void RawRecorder::record(int64_t timestampNs, const bme68xData &data) {
+  if (!active()) return;
+  if (!flushLost(timestampNs) || !pending.push({rawrec::kFrame, timestampNs, data, 0})) {
+    ++lost;
+    droppedFrames.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void RawRecorder::mark(int64_t timestampNs) {
+  if (!active()) return;
+  if (!flushLost(timestampNs) || !pending.push({rawrec::kMarker, timestampNs, {}, 0})) {
+    droppedMarks.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void RawRecorder::drain() {
+  uint32_t marks = droppedMarkers();
+  if (marks != reportedMarks) {
+    // 标记成对使用 (事件开始/结束), 丢一个会让之后的配对全部错位
+    Serial.printf("[录制] 录制队列满, 丢失 %u 个标记, 之后的事件标记不再成对\n", marks - reportedMarks);
+    reportedMarks = marks;
+  }
+  Pending p;
+  while (pending.pop(p)) {
+    write(p);
+    if (file && p.type == rawrec::kFrame && ++frameCount % FLUSH_EVERY_FRAMES == 0) fflush(file);
+  }
+}
+
+void RawRecorder::write(const Pending &p) {
+  if (!file) return;
+  int64_t timestampNs = p.timestampNs;
+  bool first = bytes == 0;
+  if (first) lastNs = timestampNs; // 文件头延迟到第一条记录时写入, 以它的时间戳作为基准
+  int64_t totalUs = (timestampNs - lastNs) / 1000;
+  if (totalUs < 0) totalUs = 0;
+  // 间隔超过 uint32 微秒时先写若干 kGap; 上限按 文件头 + 占位 + 本条 一起检查
+  uint64_t gaps = totalUs > 0 ? (uint64_t)(totalUs - 1) / UINT32_MAX : 0;
+  uint64_t need = (first ? sizeof(rawrec::FileHeader) : 0) + (gaps + 1) * sizeof(rawrec::Record);
+  if (bytes + need > limit) {
+    Serial.println("[录制] 已达文件上限, 停止录制");
+    end();
+    return;
+  }
+  if (first) {
+    rawrec::FileHeader hdr{rawrec::kMagic, rawrec::kVersion, (uint16_t)sizeof(rawrec::Record), timestampNs};
+    fwrite(&hdr, sizeof(hdr), 1, file);
+    bytes = sizeof(hdr);
+  }
+
+  int64_t dtUs = totalUs;
+  for (; gaps; --gaps) {
+    rawrec::Record gap{};
+    gap.type = rawrec::kGap;
+    gap.dtUs = UINT32_MAX;
+    fwrite(&gap, sizeof(gap), 1, file);
+    bytes += sizeof(gap);
+    dtUs -= UINT32_MAX;
+  }
+
+  rawrec::Record rec{};
+  rec.type = p.type;
+  rec.dtUs = (uint32_t)dtUs;
+  if (p.type == rawrec::kFrame) {
+    rec.status = p.data.status;
+    rec.gasIndex = p.data.gas_index;
+    rec.measIndex = p.data.meas_index;
+    rec.temperature = p.data.temperature;
+    rec.pressure = p.data.pressure;
+    rec.humidity = p.data.humidity;
+    rec.gasResistance = p.data.gas_resistance;
+  } else if (p.type == rawrec::kDropped) {
+    rec.dropped = p.dropped;
+  }
+  fwrite(&rec, sizeof(rec), 1, file);
+  bytes += sizeof(rec);
+  // 按写入的微秒数累积, 避免逐条截断误差
+  lastNs += totalUs * 1000;
+}
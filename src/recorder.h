@@ -0,0 +1,52 @@
+#pragma once
+// 原始测量录制: 把经过 envSensor.run() 的每一帧 bme68x_data 连同 BSEC 输入时间戳写入紧凑二进制文件,
+// 用于复现现场问题、在相同输入上对比算法改动 (回放见 lib/HostHal, 格式见 include/raw_record.h)。
+// record()/mark() 由采集任务调用, 只入队; 文件写入在 loop() 的 drain() 中完成, 不拖慢 BSEC 调度。
+// 队列满时丢弃的帧计入 dropped(), 并在丢帧处写入一条 kDropped 记录, 回放与分析能看到缺口;
+// 无法入队的标记计入 droppedMarkers(), 由 drain() 提示。文件 (含文件头) 不超过 maxBytes。
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <bme68xLibrary.h>
+#include "spsc_ring.h"
+
+class RawRecorder {
+public:
+  // path 为 stdio 路径 (ESP32 上需先挂载 LittleFS, 如 "/littlefs/raw.bin"); 文件达到 maxBytes 后停止写入
+  bool begin(const char *path, uint32_t maxBytes = 1024UL * 1024UL);
+  void end();
+  bool active() const { return enabled.load(std::memory_order_acquire); }
+
+  void record(int64_t timestampNs, const bme68xData &data);
+  void mark(int64_t timestampNs);
+  void drain();
+
+  uint32_t frames() const { return frameCount; }
+  uint32_t dropped() const { return droppedFrames.load(std::memory_order_relaxed); }
+  uint32_t droppedMarkers() const { return droppedMarks.load(std::memory_order_relaxed); }
+
+private:
+  struct Pending {
+    uint8_t type;
+    int64_t timestampNs;
+    bme68xData data;
+    uint32_t dropped;     // kDropped 的丢失帧数
+  };
+
+  bool flushLost(int64_t timestampNs);
+  void write(const Pending &p);
+
+  SpscRing<Pending, 32> pending;
+  std::atomic<bool> enabled{false};
+  std::atomic<uint32_t> droppedFrames{0};
+  std::atomic<uint32_t> droppedMarks{0};
+  uint32_t reportedMarks = 0;  // loop(): 已提示过的丢失标记数
+  uint32_t lost = 0;      // 采集任务: 尚未写入 kDropped 记录的丢失帧数
+  FILE *file = nullptr;
+  int64_t lastNs = 0;
+  uint32_t bytes = 0;
+  uint32_t limit = 0;
+  uint32_t frameCount = 0;
+};
+
+extern RawRecorder rawRecorder;
@@ -0,0 +1,85 @@
+#pragma once
+// 滑动窗口最小/最大值: 单调双端队列, 每个样本均摊 O(1), 内存固定。
+// 窗口按时间 (毫秒) 计, 与采样周期无关: 窗口被切成 SLOTS 个时间槽, 同一槽内只保留一个候选值,
+// 所以队列最多 SLOTS + 1 项, 数值单调上升/下降也不会溢出。代价是窗口边界按槽对齐,
+// 结果覆盖最近 window 到 window + window/SLOTS 毫秒内的全部样本。
+#include <math.h>
+#include <stdint.h>
+#include <stddef.h>
+
+template <size_t SLOTS>
+class RollingExtrema {
+  static_assert(SLOTS >= 1 && SLOTS < 255, "RollingExtrema slot count out of range");
+
+public:
+  // 修改窗口长度会清空已有样本
+  void setWindow(uint32_t ms) {
+    windowMs = ms;
+    slotMs = ms / SLOTS ? ms / SLOTS : 1;
+    clear();
+  }
+  uint32_t window() const { return windowMs; }
+  void clear() {
+    lo.clear();
+    hi.clear();
+  }
+
+  // 时间戳需单调; 回退 (重新初始化、回放) 时从头开始。NAN 被忽略
+  void push(int64_t tsMs, float x) {
+    if (isnan(x) || tsMs < 0) return;
+    uint32_t slot = (uint32_t)(tsMs / slotMs);
+    if ((!lo.empty() && slot < lo.back().slot) || (!hi.empty() && slot < hi.back().slot)) clear();
+    uint32_t oldest = slot > SLOTS ? slot - SLOTS : 0;
+    lo.expire(oldest);
+    hi.expire(oldest);
+    lo.push<false>(slot, x);
+    hi.push<true>(slot, x);
+  }
+
+  // 窗口内没有样本时为 NAN
+  float min() const { return lo.empty() ? NAN : lo.front().v; }
+  float max() const { return hi.empty() ? NAN : hi.front().v; }
+
+private:
+  struct Entry {
+    uint32_t slot;
+    float v;
+  };
+
+  // 固定容量的环形双端队列; 队首为当前极值, 从队首到队尾槽号递增、数值单调
+  class Deque {
+  public:
+    bool empty() const { return n == 0; }
+    void clear() { n = 0; }
+    const Entry &front() const { return e[head]; }
+    const Entry &back() const { return e[at(n - 1)]; }
+
+    void expire(uint32_t oldest) {
+      while (n && e[head].slot < oldest) {
+        head = at(1);
+        --n;
+      }
+    }
+
+    // 弹出被 x 支配的队尾项 (最小值队列: >= x; 最大值队列: <= x); 同一槽内已有更优的候选时不再入队
+    template <bool MAX>
+    void push(uint32_t slot, float x) {
+      while (n && (MAX ? back().v <= x : back().v >= x)) --n;
+      if (n && back().slot == slot) return;
+      e[at(n)] = Entry{slot, x};
+      ++n;
+    }
+
+  private:
+    static const uint8_t CAP = SLOTS + 1;
+    uint8_t at(uint8_t i) const { return (uint8_t)((head + i) % CAP); }
+
+    Entry e[CAP];
+    uint8_t head = 0;
+    uint8_t n = 0;
+  };
+
+  uint32_t windowMs = 0;
+  uint32_t slotMs = 1;
+  Deque lo, hi;
+};
@@ -0,0 +1,252 @@
+#include "sample_history.h"
+#include <string.h>
+
+static const int32_t NAN_Q = INT32_MIN;         // 缺失值的量化结果
+static const size_t MIN_POOL_BYTES = 128UL * 1024UL; // 至少 32 块, 多于同时打开的块数 (每个传感器一个)
+static const uint32_t WORST_SAMPLE_BITS = 4 + 24 + HISTORY_FIELD_COUNT * (4 + 32);
+
+static inline uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static inline int64_t unzigzag(uint64_t u) { return (int64_t)(u >> 1) ^ -(int64_t)(u & 1); }
+
+static int32_t quantize(const HistoryField &f, const SensorValues &vals) {
+  float v = f.value ? vals.*f.value : (float)(vals.*f.u8);
+  if (isnan(v) || (f.logScale && v <= 0)) return NAN_Q;
+  double x = (f.logScale ? log((double)v) : (double)v) / f.quantum;
+  if (x > 2147483647.0 || x < -2147483647.0) return NAN_Q;
+  return (int32_t)llround(x);
+}
+
+static float dequantize(const HistoryField &f, int32_t q) {
+  if (q == NAN_Q) return NAN;
+  double x = (double)q * f.quantum;
+  return (float)(f.logScale ? exp(x) : x);
+}
+
+// ---- 位流: 高位在前 ----
+static void putBits(uint8_t *buf, uint32_t &pos, uint64_t v, uint8_t n) {
+  while (n) {
+    uint8_t room = 8 - (pos & 7);
+    uint8_t take = n < room ? n : room;
+    uint8_t chunk = (uint8_t)((v >> (n - take)) & ((1u << take) - 1));
+    buf[pos >> 3] |= chunk << (room - take);
+    pos += take;
+    n -= take;
+  }
+}
+
+static uint64_t getBits(const uint8_t *buf, uint32_t &pos, uint8_t n) {
+  uint64_t v = 0;
+  while (n) {
+    uint8_t room = 8 - (pos & 7);
+    uint8_t take = n < room ? n : room;
+    v = (v << take) | ((buf[pos >> 3] >> (room - take)) & ((1u << take) - 1));
+    pos += take;
+    n -= take;
+  }
+  return v;
+}
+
+// 前缀码: 0 / 10 / 110 / 1110 / 1111 对应档位 0-4
+static void putPrefix(uint8_t *buf, uint32_t &pos, uint8_t k) {
+  if (k < 4) {
+    putBits(buf, pos, ((1u << k) - 1) << 1, k + 1);
+  } else {
+    putBits(buf, pos, 0xF, 4);
+  }
+}
+
+static uint8_t getPrefix(const uint8_t *buf, uint32_t &pos) {
+  uint8_t k = 0;
+  while (k < 4 && getBits(buf, pos, 1)) ++k;
+  return k;
+}
+
+// 时间戳二阶差分各档的位数; 超出最后一档时另起一块
+static const uint8_t DOD_BITS[] = {0, 8, 14, 24};
+// 数值差分各档的位数; 最后一档 (1111) 为 32 位绝对值
+static const uint8_t DELTA_BITS[] = {0, 3, 6, 12};
+
+size_t SampleHistory::begin(size_t bytes) {
+  while (!pool && bytes >= MIN_POOL_BYTES) {
+#if defined(HOST_BUILD)
+    pool = (uint8_t *)malloc(bytes);
+#else
+    pool = (uint8_t *)ps_malloc(bytes);
+#endif
+    if (!pool) bytes /= 2;
+  }
+  if (!pool) return 0;
+  nBlocks = (uint32_t)(bytes / BLOCK_BYTES);
+  for (uint32_t b = 0; b < nBlocks; ++b) header(b).seq = 0;
+  nextAlloc = used = seq = 0;
+  totalBits = totalSamples = 0;
+  for (uint8_t i = 0; i < MAX_SENSORS; ++i) writers[i].open = false;
+  return poolBytes();
+}
+
+void SampleHistory::startBlock(uint8_t i, int64_t tsMs) {
+  uint32_t b = nextAlloc;
+  nextAlloc = (nextAlloc + 1) % nBlocks;
+  BlockHeader &h = header(b);
+  if (h.seq == 0) {
+    ++used;
+  } else if (writers[h.sensor].open && writers[h.sensor].block == b) {
+    writers[h.sensor].open = false; // 最旧的块恰好是某个传感器正在写的块 (该传感器极慢): 它下次另起一块
+  }
+  h.seq = ++seq;
+  h.sensor = i;
+  h.reserved = 0;
+  h.count = 0;
+  h.bits = 0;
+  h.pad = 0;
+  h.firstMs = h.lastMs = tsMs;
+  memset(payload(b), 0, BLOCK_BYTES - sizeof(BlockHeader));
+  Writer &w = writers[i];
+  w.open = true;
+  w.block = b;
+  w.ts = tsMs;
+  w.delta = 0;
+}
+
+void SampleHistory::append(const SensorValues &vals) {
+  if (!pool || vals.sensor >= MAX_SENSORS) return;
+  int32_t q[HISTORY_FIELD_COUNT];
+  for (uint8_t f = 0; f < HISTORY_FIELD_COUNT; ++f) q[f] = quantize(HISTORY_FIELDS[f], vals);
+
+  Writer &w = writers[vals.sensor];
+  bool fresh = !w.open;
+  if (w.open) {
+    const BlockHeader &h = header(w.block);
+    int64_t dod = (vals.timestampMs - w.ts) - w.delta;
+    // 块写满、时间回退 (回放/重新初始化) 或间隔变化超出编码范围时另起一块
+    fresh = h.count == UINT16_MAX || h.bits + WORST_SAMPLE_BITS > PAYLOAD_BITS || vals.timestampMs < w.ts ||
+            zigzag(dod) >= (1ULL << DOD_BITS[3]);
+  }
+  if (fresh) startBlock(vals.sensor, vals.timestampMs);
+  encode(w, vals.timestampMs, q);
+}
+
+void SampleHistory::encode(Writer &w, int64_t tsMs, const int32_t *q) {
+  BlockHeader &h = header(w.block);
+  uint8_t *buf = payload(w.block);
+  uint32_t pos = h.bits;
+  bool first = h.count == 0;
+
+  int64_t delta = tsMs - w.ts;
+  uint64_t u = zigzag(delta - w.delta);
+  uint8_t k = 0;
+  while (k < 3 && u >= (1ULL << DOD_BITS[k])) ++k;
+  putPrefix(buf, pos, k);
+  putBits(buf, pos, u, DOD_BITS[k]);
+  w.ts = tsMs;
+  w.delta = delta;
+
+  for (uint8_t f = 0; f < HISTORY_FIELD_COUNT; ++f) {
+    int32_t prev = w.q[f], cur = q[f];
+    w.q[f] = cur;
+    if (!first && cur == prev) {
+      putBits(buf, pos, 0, 1);
+      continue;
+    }
+    if (!first && cur != NAN_Q && prev != NAN_Q) {
+      uint64_t d = zigzag((int64_t)cur - prev);
+      k = 1;
+      while (k < 4 && d >= (1ULL << DELTA_BITS[k])) ++k;
+      if (k < 4) {
+        putPrefix(buf, pos, k);
+        putBits(buf, pos, d, DELTA_BITS[k]);
+        continue;
+      }
+    }
+    putPrefix(buf, pos, 4);
+    putBits(buf, pos, (uint32_t)cur, 32);
+  }
+
+  totalBits += pos - h.bits;
+  ++totalSamples;
+  h.bits = pos;
+  h.lastMs = tsMs;
+  ++h.count;
+}
+
+HistoryCursor SampleHistory::query(uint8_t sensor, int64_t fromMs, int64_t toMs) const {
+  HistoryCursor c;
+  c.store = this;
+  c.sensor = sensor;
+  c.fromMs = fromMs;
+  c.toMs = toMs;
+  c.done = !pool;
+  return c;
+}
+
+uint32_t SampleHistory::samples(uint8_t i, int64_t &oldestMs, int64_t &newestMs, uint32_t &blocks) const {
+  uint32_t n = 0;
+  blocks = 0;
+  oldestMs = newestMs = 0;
+  for (uint32_t b = 0; pool && b < nBlocks; ++b) {
+    const BlockHeader &h = header(b);
+    if (h.seq == 0 || h.sensor != i || h.count == 0) continue;
+    if (!blocks || h.firstMs < oldestMs) oldestMs = h.firstMs;
+    if (!blocks || h.lastMs > newestMs) newestMs = h.lastMs;
+    ++blocks;
+    n += h.count;
+  }
+  return n;
+}
+
+// 按分配顺序 (即各传感器的时间顺序) 找下一个属于该传感器且与查询范围相交的块; 只读块头
+bool HistoryCursor::openBlock() {
+  const SampleHistory &s = *store;
+  while (visited < s.used) {
+    uint32_t b = (s.nextAlloc + s.nBlocks - s.used + visited) % s.nBlocks;
+    ++visited;
+    const SampleHistory::BlockHeader &h = s.header(b);
+    if (h.sensor != sensor || h.count == 0 || h.lastMs < fromMs) continue;
+    if (h.firstMs > toMs) break;
+    block = b;
+    bitPos = 0;
+    left = h.count;
+    ts = h.firstMs;
+    delta = 0;
+    return true;
+  }
+  return false;
+}
+
+bool HistoryCursor::next(HistorySample &out) {
+  while (!done) {
+    if (!inBlock) {
+      inBlock = openBlock();
+      if (!inBlock) {
+        done = true;
+        break;
+      }
+    }
+    if (left == 0) {
+      inBlock = false;
+      continue;
+    }
+    const uint8_t *buf = store->payload(block);
+    uint8_t k = getPrefix(buf, bitPos);
+    delta += unzigzag(getBits(buf, bitPos, DOD_BITS[k]));
+    ts += delta;
+    for (uint8_t f = 0; f < HISTORY_FIELD_COUNT; ++f) {
+      k = getPrefix(buf, bitPos);
+      if (k == 4) {
+        q[f] = (int32_t)(uint32_t)getBits(buf, bitPos, 32);
+      } else if (k > 0) {
+        q[f] = (int32_t)((int64_t)q[f] + unzigzag(getBits(buf, bitPos, DELTA_BITS[k])));
+      }
+    }
+    --left;
+    if (ts < fromMs) continue;
+    if (ts > toMs) {
+      done = true;
+      break;
+    }
+    out.timestampMs = ts;
+    for (uint8_t f = 0; f < HISTORY_FIELD_COUNT; ++f) out.v[f] = dequantize(HISTORY_FIELDS[f], q[f]);
+    return true;
+  }
+  return false;
+}
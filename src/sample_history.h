@@ -0,0 +1,98 @@
+#pragma once
+// 压缩的样本历史: 所有 HISTORY_FIELDS 通道的逐样本记录, 放在 PSRAM 中, 供趋势图与导出读取。
+// - 按固定大小的块组织 (4 KB): 块头记录传感器、样本数与时间范围, 查询时只解码时间范围相交的块;
+// - 时间戳存二阶差分 (delta-of-delta): 采样周期不变时每个样本 1 位;
+// - 数值按通道的 quantum 量化成整数后存与上一样本的差值, 以前缀码分 0/3/6/12 位几档, 不变的通道 1 位,
+//   NAN 与大跳变直接存 32 位绝对值; 每块第一个样本全部存绝对值, 块可以独立解码;
+// - 追加 O(1): 只写当前块; 池满时回收最旧的块 (环形), 保留最近的数据。
+// 主机 24 小时仿真平均约 6.5 字节/样本 (11 个通道), 6 MB 在 LP (3 s) 下可保存单个传感器约 33 天, 只比 30 天多一成;
+// 多个传感器共享池, 保存天数按传感器数均分。只由 loop() 访问。
+#include <Arduino.h>
+#include "sensor_values.h"
+#include "sensor_array.h"
+
+struct HistorySample {
+  int64_t timestampMs;
+  float v[HISTORY_FIELD_COUNT];  // 与 HISTORY_FIELDS 同序, 量化后的值; 缺失为 NAN
+};
+
+class SampleHistory;
+
+// 按时间顺序解码一个传感器在 [fromMs, toMs] 内的样本
+class HistoryCursor {
+public:
+  bool next(HistorySample &out);
+
+private:
+  friend class SampleHistory;
+  bool openBlock();
+
+  const SampleHistory *store = nullptr;
+  uint8_t sensor = 0;
+  int64_t fromMs = 0, toMs = 0;
+  uint32_t visited = 0;       // 已检查的块数 (按分配顺序, 从最旧开始)
+  uint32_t block = 0;
+  bool inBlock = false;
+  bool done = false;
+  uint32_t bitPos = 0;
+  uint16_t left = 0;          // 当前块剩余样本数
+  int64_t ts = 0, delta = 0;
+  int32_t q[HISTORY_FIELD_COUNT];
+};
+
+class SampleHistory {
+public:
+  // 分配 bytes 字节的池 (设备上从 PSRAM), 失败时逐次减半, 最小 128 KB (MIN_POOL_BYTES); 返回实际大小, 0 = 不可用
+  size_t begin(size_t bytes);
+  bool active() const { return pool != nullptr; }
+
+  void append(const SensorValues &vals);
+  HistoryCursor query(uint8_t sensor, int64_t fromMs, int64_t toMs) const;
+
+  // 统计: 传感器 i 保存的样本数、时间范围与占用的块数
+  uint32_t samples(uint8_t i, int64_t &oldestMs, int64_t &newestMs, uint32_t &blocks) const;
+  uint32_t blockCount() const { return nBlocks; }
+  uint32_t blocksUsed() const { return used; }
+  size_t poolBytes() const { return (size_t)nBlocks * BLOCK_BYTES; }
+  uint64_t bitsWritten() const { return totalBits; }
+  uint64_t samplesWritten() const { return totalSamples; }
+
+  static const uint32_t BLOCK_BYTES = 4096;
+
+private:
+  friend class HistoryCursor;
+
+  struct BlockHeader {
+    uint32_t seq;      // 分配顺序, 0 = 空闲
+    uint8_t sensor;
+    uint8_t reserved;
+    uint16_t count;    // 样本数
+    uint32_t bits;     // 已写入的负载位数
+    uint32_t pad;
+    int64_t firstMs;
+    int64_t lastMs;
+  };
+  static const uint32_t PAYLOAD_BITS = (BLOCK_BYTES - sizeof(BlockHeader)) * 8;
+
+  // 每个传感器的编码状态: 当前块与上一样本
+  struct Writer {
+    bool open = false;
+    uint32_t block = 0;
+    int64_t ts = 0, delta = 0;
+    int32_t q[HISTORY_FIELD_COUNT];
+  };
+
+  BlockHeader &header(uint32_t b) const { return *(BlockHeader *)(pool + (size_t)b * BLOCK_BYTES); }
+  uint8_t *payload(uint32_t b) const { return pool + (size_t)b * BLOCK_BYTES + sizeof(BlockHeader); }
+  void startBlock(uint8_t i, int64_t tsMs);
+  void encode(Writer &w, int64_t tsMs, const int32_t *q);
+
+  uint8_t *pool = nullptr;
+  uint32_t nBlocks = 0;
+  uint32_t nextAlloc = 0;  // 下一个分配的块 (环形); 池满后即最旧的块
+  uint32_t used = 0;
+  uint32_t seq = 0;
+  uint64_t totalBits = 0;
+  uint64_t totalSamples = 0;
+  Writer writers[MAX_SENSORS];
+};
@@ -0,0 +1,61 @@
+#include "sample_mode.h"
+
+const SampleModeInfo SAMPLE_MODES[MODE_COUNT] = {
+  {"ulp", BSEC_SAMPLE_RATE_ULP, TEMP_OFFSET_ULP},
+  {"lp", BSEC_SAMPLE_RATE_LP, TEMP_OFFSET_LP},
+  {"cont", BSEC_SAMPLE_RATE_CONT, TEMP_OFFSET_LP},
+  {"scan", BSEC_SAMPLE_RATE_SCAN, TEMP_OFFSET_LP},
+};
+
+// 能耗估算: run() 期间按 BME688 加热测量电流计 (数据手册加热时约 12 mA), 其余时间为睡眠电流, 供电 3.3 V
+static const float MEAS_CURRENT_MA = 12.0f;
+static const float SLEEP_CURRENT_MA = 0.00015f;
+static const float SUPPLY_V = 3.3f;
+
+SampleMode sampleModeByName(const char *name) {
+  for (uint8_t i = 0; i < MODE_COUNT; ++i) {
+    if (strcmp(SAMPLE_MODES[i].name, name) == 0) return (SampleMode)i;
+  }
+  return MODE_COUNT;
+}
+
+void SampleModeStats::enter(SampleMode mode, uint64_t nowMs) {
+  stats[current].ms += nowMs - enteredMs;
+  current = mode;
+  enteredMs = nowMs;
+}
+
+void SampleModeStats::subscribe(uint8_t sensor, SampleMode mode, uint64_t nowMs) {
+  if (sensor >= SLOTS) return;
+  if (slotMode[sensor] != MODE_COUNT) stats[slotMode[sensor]].sensorMs += nowMs - slotSinceMs[sensor];
+  slotMode[sensor] = mode;
+  slotSinceMs[sensor] = nowMs;
+}
+
+void SampleModeStats::reset(uint64_t nowMs) {
+  for (uint8_t i = 0; i < MODE_COUNT; ++i) stats[i] = Entry{};
+  enteredMs = nowMs;
+  for (uint8_t i = 0; i < SLOTS; ++i) slotSinceMs[i] = nowMs;
+}
+
+void SampleModeStats::print(uint64_t nowMs) const {
+  Serial.printf("=== 采样模式 (当前: %s, 周期 %.1f s) ===\n", SAMPLE_MODES[current].name, 1.0f / SAMPLE_MODES[current].rate);
+  Serial.println("模式  时长min    输出  输出/分  run占空%  估算mA  mJ/输出  (后四列按每个传感器)");
+  for (uint8_t i = 0; i < MODE_COUNT; ++i) {
+    uint64_t ms = stats[i].ms + (i == current ? nowMs - enteredMs : 0);
+    uint64_t sensorMs = stats[i].sensorMs;
+    for (uint8_t s = 0; s < SLOTS; ++s) {
+      if (slotMode[s] == i) sensorMs += nowMs - slotSinceMs[s];
+    }
+    if (ms == 0 && sensorMs == 0) continue;
+    const Entry &e = stats[i];
+    float sensorMinutes = sensorMs / 60000.0f;
+    float duty = sensorMs ? (float)e.runUs / 1000.0f / (float)sensorMs : 0.0f;
+    float avgMa = MEAS_CURRENT_MA * duty + SLEEP_CURRENT_MA * (1.0f - duty);
+    float energyMj = avgMa * SUPPLY_V * (sensorMs / 1000.0f); // mA * V * s = mJ
+    Serial.printf("%-5s %7.1f %7u %8.2f %9.3f %7.3f %8.1f\n", SAMPLE_MODES[i].name, ms / 60000.0f, e.outputs,
+                  sensorMinutes > 0 ? e.outputs / sensorMinutes : 0.0f, duty * 100.0f, avgMa,
+                  e.outputs ? energyMj / e.outputs : 0.0f);
+  }
+  Serial.println("==========================================");
+}
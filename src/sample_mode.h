@@ -0,0 +1,62 @@
+#pragma once
+// BSEC 采样模式 (ULP/LP/CONT/SCAN) 及各模式的实测开销统计。
+// 切换本身在 main.cpp 的 setSampleMode() 中完成 (只对当前订阅重新调用 updateSubscription, 不重新 begin, BSEC 状态保留);
+// 这里记录每个模式下的停留时长、BSEC 输出数与 run() 占用时间, 用来比较各模式的有效输出率与 CPU/能耗。
+// 多传感器切换模式时各自错开相位重新订阅, 输出、run() 耗时与订阅时长都记在产生它的传感器实际订阅的模式上。
+#include <Arduino.h>
+#include "bsec_backend.h"
+
+enum SampleMode : uint8_t { MODE_ULP, MODE_LP, MODE_CONT, MODE_SCAN, MODE_COUNT };
+
+struct SampleModeInfo {
+  const char *name;  // 串口命令中使用的名称
+  float rate;        // BSEC_SAMPLE_RATE_*
+  float tempOffset;  // 该模式下的自热温度偏移
+};
+
+extern const SampleModeInfo SAMPLE_MODES[MODE_COUNT];
+
+// 按名称查找模式, 未找到返回 MODE_COUNT
+SampleMode sampleModeByName(const char *name);
+
+inline uint32_t samplePeriodMs(SampleMode mode) {
+  return (uint32_t)lroundf(1000.0f / SAMPLE_MODES[mode].rate);
+}
+
+class SampleModeStats {
+public:
+  static const uint8_t SLOTS = 16;  // 传感器槽位数 (MAX_SENSORS)
+
+  SampleModeStats() {
+    for (uint8_t i = 0; i < SLOTS; ++i) slotMode[i] = MODE_COUNT;
+  }
+
+  // 采集任务调用
+  void enter(SampleMode mode, uint64_t nowMs);
+  // 传感器以 mode 订阅 (MODE_COUNT = 未订阅/暂停) 的时刻; 之前的订阅时长记入原模式
+  void subscribe(uint8_t sensor, SampleMode mode, uint64_t nowMs);
+  void onRun(uint8_t sensor, uint32_t runUs, bool produced) {
+    if (sensor >= SLOTS || slotMode[sensor] == MODE_COUNT) return;
+    Entry &e = stats[slotMode[sensor]];
+    e.runUs += runUs;
+    if (produced) ++e.outputs;
+  }
+
+  // 打印各模式: 停留时长、输出数, 以及按传感器订阅时长折算的 输出/分钟、run() 占空比、传感器平均电流与每次输出能耗估算
+  void print(uint64_t nowMs) const;
+  void reset(uint64_t nowMs);
+
+private:
+  struct Entry {
+    uint64_t ms;        // 在该模式下累计停留时长 (不含当前这段)
+    uint64_t sensorMs;  // 各传感器以该模式订阅的累计时长 (不含正在进行的订阅)
+    uint32_t outputs;
+    uint64_t runUs;     // envSensor.run() 累计耗时 (含等待测量完成)
+  };
+
+  Entry stats[MODE_COUNT]{};
+  SampleMode current = MODE_LP;
+  uint64_t enteredMs = 0;
+  SampleMode slotMode[SLOTS];
+  uint64_t slotSinceMs[SLOTS]{};
+};
@@ -0,0 +1,158 @@
+#include "sensor_array.h"
+
+SensorArray sensors;
+
+#if defined(USE_BSEC2)
+// 每个 Bsec2 实例的算法内存 (多实例时不能共用库内部的默认实例); 轻量构建没有算法内存
+static uint8_t bsecMem[MAX_SENSORS][BSEC_INSTANCE_SIZE];
+#endif
+
+static const uint8_t CHANNEL_UNKNOWN = 0xFE;
+
+// bme68x 总线回调: 先切换到传感器所在通道, 再按 Bosch Arduino 库相同的方式读写寄存器
+BME68X_INTF_RET_TYPE SensorArray::busRead(uint8_t reg, uint8_t *data, uint32_t len, void *intfPtr) {
+  const BusRef *ref = (const BusRef *)intfPtr;
+  TwoWire &w = *ref->array->wire;
+  if (!ref->array->select(ref->bus->channel)) return BME68X_E_COM_FAIL;
+  w.beginTransmission(ref->bus->addr);
+  w.write(reg);
+  if (w.endTransmission() != 0) return BME68X_E_COM_FAIL;
+  if (w.requestFrom(ref->bus->addr, (uint8_t)len) != len) return BME68X_E_COM_FAIL;
+  for (uint32_t i = 0; i < len; ++i) data[i] = (uint8_t)w.read();
+  return BME68X_INTF_RET_SUCCESS;
+}
+
+BME68X_INTF_RET_TYPE SensorArray::busWrite(uint8_t reg, const uint8_t *data, uint32_t len, void *intfPtr) {
+  const BusRef *ref = (const BusRef *)intfPtr;
+  TwoWire &w = *ref->array->wire;
+  if (!ref->array->select(ref->bus->channel)) return BME68X_E_COM_FAIL;
+  w.beginTransmission(ref->bus->addr);
+  w.write(reg);
+  for (uint32_t i = 0; i < len; ++i) w.write(data[i]);
+  return w.endTransmission() == 0 ? BME68X_INTF_RET_SUCCESS : BME68X_E_COM_FAIL;
+}
+
+bool SensorArray::probe(uint8_t addr) {
+  wire->beginTransmission(addr);
+  return wire->endTransmission() == 0;
+}
+
+bool SensorArray::select(uint8_t channel) {
+  if (!muxFound) return channel == MUX_DIRECT;
+  if (channel == currentChannel) return true;
+  wire->beginTransmission(MUX_ADDR);
+  wire->write(channel == MUX_DIRECT ? 0 : (uint8_t)(1u << channel));
+  if (wire->endTransmission() != 0) {
+    currentChannel = CHANNEL_UNKNOWN;
+    return false;
+  }
+  currentChannel = channel;
+  return true;
+}
+
+uint8_t SensorArray::discover(TwoWire &w) {
+  static const uint8_t ADDRS[2] = {BME68X_I2C_ADDR_LOW, BME68X_I2C_ADDR_HIGH};
+  wire = &w;
+  n = 0;
+  currentChannel = CHANNEL_UNKNOWN;
+  muxFound = probe(MUX_ADDR);
+  select(MUX_DIRECT);
+
+  // 主总线: 关闭所有通道后探测; 通道上与主总线同地址的传感器会和它冲突, 因此跳过
+  bool direct[2] = {false, false};
+  for (uint8_t a = 0; a < 2; ++a) {
+    if (!probe(ADDRS[a])) continue;
+    direct[a] = true;
+    slots[n++].bus = {MUX_DIRECT, ADDRS[a]};
+  }
+  for (uint8_t ch = 0; muxFound && ch < MUX_CHANNELS && n < MAX_SENSORS; ++ch) {
+    if (!select(ch)) continue;
+    for (uint8_t a = 0; a < 2 && n < MAX_SENSORS; ++a) {
+      if (!direct[a] && probe(ADDRS[a])) slots[n++].bus = {ch, ADDRS[a]};
+    }
+  }
+  select(MUX_DIRECT);
+
+  for (uint8_t i = 0; i < n; ++i) {
+    SensorSlot &s = slots[i];
+    s.pacer.reset();
+    s.values = SensorValues();
+    s.values.sensor = i;
+    s.activeMask = 0;
+    s.outputCount = 0;
+    s.lastOutputTsMs = 0;
+    s.configAtMs = -1;
+    s.periodMs = 0;
+    s.lastRunUs = 0;
+#if defined(USE_BSEC2)
+    s.bsec.allocateMemory(bsecMem[i]);
+#endif
+    s.ref = {this, &s.bus};
+    s.ok = s.bsec.begin(BME68X_I2C_INTF, busRead, busWrite, bme68xDelayUs, &s.ref);
+  }
+  return n;
+}
+
+void SensorArray::scan(I2cScanResult &r) {
+  r.count = 0;
+  r.listed = 0;
+  bool seen[128] = {false};
+  select(MUX_DIRECT);
+  for (uint8_t addr = 1; addr < 127; ++addr) {
+    if (probe(addr)) {
+      if (r.listed < I2cScanResult::MAX_LISTED) r.found[r.listed++] = {MUX_DIRECT, addr};
+      seen[addr] = true;
+      ++r.count;
+    }
+  }
+  for (uint8_t ch = 0; muxFound && ch < MUX_CHANNELS; ++ch) {
+    if (!select(ch)) continue;
+    for (uint8_t addr = 1; addr < 127; ++addr) {
+      if (!seen[addr] && probe(addr)) {
+        if (r.listed < I2cScanResult::MAX_LISTED) r.found[r.listed++] = {ch, addr};
+        ++r.count;
+      }
+    }
+  }
+  select(MUX_DIRECT);
+}
+
+void I2cScanResult::print() const {
+  Serial.println("=== I2C 设备扫描 ===");
+  for (uint8_t i = 0; i < listed; ++i) {
+    if (found[i].channel == MUX_DIRECT) {
+      Serial.printf("发现 I2C 设备于地址 0x%02X\n", found[i].addr);
+    } else {
+      Serial.printf("发现 I2C 设备于 TCA9548A 通道 %u 地址 0x%02X\n", found[i].channel, found[i].addr);
+    }
+  }
+  if (count > listed) Serial.printf("... 另有 %u 个未列出\n", count - listed);
+  Serial.printf("扫描完成, 共发现 %u 个设备\n", count);
+  Serial.println("==================");
+}
+
+void SensorArray::stateKey(uint8_t i, char *key, size_t len) const {
+  const SensorBus &b = slots[i].bus;
+  if (i == 0 && b.channel == MUX_DIRECT) {
+    snprintf(key, len, "state");
+  } else {
+    snprintf(key, len, "st_%02x_%02x", b.channel, b.addr);
+  }
+}
+
+void SensorArray::describe(uint8_t i, char *buf, size_t len) const {
+  const SensorBus &b = slots[i].bus;
+  if (b.channel == MUX_DIRECT) {
+    snprintf(buf, len, "主总线 0x%02X", b.addr);
+  } else {
+    snprintf(buf, len, "通道%u 0x%02X", b.channel, b.addr);
+  }
+}
+
+void SensorArray::snapshot(SensorTable &t) const {
+  t.count = n;
+  for (uint8_t i = 0; i < n; ++i) {
+    describe(i, t.where[i], sizeof(t.where[i]));
+    stateKey(i, t.stateKey[i], sizeof(t.stateKey[i]));
+  }
+}
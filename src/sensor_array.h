@@ -0,0 +1,92 @@
+#pragma once
+// 多传感器: 每个 BME688 一个 Bsec2 实例 (独立算法内存与状态 blob)。传感器可以直接挂在主总线的 0x76/0x77,
+// 也可以挂在 TCA9548A (0x70) 的 8 个通道后, 每通道两个地址, 总数上限 16。
+// 经多路复用器的传感器用 Bsec2 的自定义总线 begin(): 读写回调先切换通道 (缓存当前通道, 不重复写), 再访问设备。
+// 所有传感器在采集任务里顺序 run(): 测量 (加热) 永远不会重叠; 各传感器的起始相位按 周期/N 错开, 让总线忙而不挤。
+#include <Arduino.h>
+#include <Wire.h>
+#include "bsec_backend.h"
+#include "bsec_pacer.h"
+#include "sensor_values.h"
+
+static const uint8_t MAX_SENSORS = 16;
+static const uint8_t MUX_ADDR = 0x70;     // TCA9548A 默认地址 (A0..A2 接地)
+static const uint8_t MUX_CHANNELS = 8;
+static const uint8_t MUX_DIRECT = 0xFF;   // 不经多路复用器
+
+struct SensorBus {
+  uint8_t channel;  // 多路复用器通道, MUX_DIRECT 表示主总线
+  uint8_t addr;
+};
+
+class SensorArray;
+
+// bme68x 回调的 intf 指针: 通道切换与寄存器读写都经所属阵列 discover() 时传入的总线
+struct BusRef {
+  SensorArray *array;
+  const SensorBus *bus;
+};
+
+struct SensorSlot {
+  Bsec2 bsec;
+  SensorBus bus{MUX_DIRECT, 0};
+  BusRef ref{nullptr, nullptr};
+  BsecPacer pacer;
+  SensorValues values;            // BSEC 回调中填充的最新输出 (采集任务独占)
+  BsecOutputMask activeMask = 0;  // 当前已订阅的输出
+  uint32_t outputCount = 0;
+  int64_t lastOutputTsMs = 0;
+  int64_t configAtMs = -1;        // >= 0: 到该时刻再按当前采样模式重新订阅 (错开相位)
+  uint32_t periodMs = 0;          // 当前订阅的采样周期, 0 表示未订阅
+  uint32_t lastRunUs = 0;         // 最近一次产生输出的 run() 耗时
+  bool ok = false;
+};
+
+// loop() 使用的传感器表: discover() 会改写 SensorArray (采集任务独占), loop() 只读这份副本。
+// 采集任务每次重建实例后复制一份, 经 sensorsReinitDue 交给 loop()
+struct SensorTable {
+  uint8_t count = 0;
+  char where[MAX_SENSORS][24] = {};    // describe()
+  char stateKey[MAX_SENSORS][14] = {}; // stateKey()
+};
+
+// scan() 的结果: 采集任务填写, loop() 打印 (扫描要访问总线, 打印要等 UART, 分在两个任务里)
+struct I2cScanResult {
+  static const uint8_t MAX_LISTED = 32;
+  uint16_t count = 0;              // 发现的设备总数
+  uint8_t listed = 0;              // found[] 中的条目数, 超过 MAX_LISTED 的只计数
+  SensorBus found[MAX_LISTED] = {};
+  void print() const;
+};
+
+class SensorArray {
+public:
+  // 扫描主总线与多路复用器各通道, 为找到的传感器 begin() 对应的 Bsec2; 返回传感器数量
+  uint8_t discover(TwoWire &wire);
+  uint8_t count() const { return n; }
+  SensorSlot &operator[](uint8_t i) { return slots[i]; }
+  bool hasMux() const { return muxFound; }
+
+  // 切换多路复用器通道 (MUX_DIRECT 关闭所有通道), 已是当前通道时不访问总线
+  bool select(uint8_t channel);
+  // 扫描主总线与各通道上的全部 I2C 设备
+  void scan(I2cScanResult &r);
+
+  // NVS 中保存该传感器状态 blob 的键; 主总线上的第一个传感器沿用单传感器时代的 "state"
+  void stateKey(uint8_t i, char *key, size_t len) const;
+  void describe(uint8_t i, char *buf, size_t len) const;
+  void snapshot(SensorTable &t) const;
+
+private:
+  bool probe(uint8_t addr);
+  static BME68X_INTF_RET_TYPE busRead(uint8_t reg, uint8_t *data, uint32_t len, void *intfPtr);
+  static BME68X_INTF_RET_TYPE busWrite(uint8_t reg, const uint8_t *data, uint32_t len, void *intfPtr);
+
+  SensorSlot slots[MAX_SENSORS];
+  uint8_t n = 0;
+  bool muxFound = false;
+  uint8_t currentChannel = MUX_DIRECT;
+  TwoWire *wire = nullptr;
+};
+
+extern SensorArray sensors;
@@ -0,0 +1,60 @@
+#include "sensor_values.h"
+
+namespace {
+// 虚拟传感器 id -> BSEC_FIELDS 下标 (-1 表示未映射), 首次使用时由映射表生成, 解析时 O(1) 查找
+const uint8_t MAX_SENSOR_ID = 32;
+
+struct FieldIndex {
+  int8_t slot[MAX_SENSOR_ID];
+  FieldIndex() {
+    for (uint8_t i = 0; i < MAX_SENSOR_ID; ++i) slot[i] = -1;
+    for (uint8_t i = 0; i < BSEC_FIELD_COUNT; ++i) slot[BSEC_FIELDS[i].id] = (int8_t)i;
+  }
+};
+
+const FieldIndex &fieldIndex() {
+  static const FieldIndex index;
+  return index;
+}
+} // namespace
+
+BsecSubscription bsecSubscription(BsecOutputMask mask) {
+  BsecSubscription sub{};
+  for (uint8_t i = 0; i < BSEC_FIELD_COUNT; ++i) {
+    if (!(mask & bsecMask(BSEC_FIELDS[i].id))) continue;
+    sub.ids[sub.count++] = BSEC_FIELDS[i].id;
+    sub.mask |= bsecMask(BSEC_FIELDS[i].id);
+  }
+  return sub;
+}
+
+BsecOutputMask bsecFieldMask(float SensorValues::*value, uint8_t SensorValues::*u8) {
+  BsecOutputMask mask = 0;
+  for (uint8_t i = 0; i < BSEC_FIELD_COUNT; ++i) {
+    const BsecField &f = BSEC_FIELDS[i];
+    if ((value && f.signal == value) || (u8 && f.accuracy == u8)) mask |= bsecMask(f.id);
+  }
+  return mask;
+}
+
+void applyBsecOutputs(const bsecOutputs &outputs, SensorValues &vals) {
+  const FieldIndex &index = fieldIndex();
+  for (uint8_t i = 0; i < outputs.nOutputs; ++i) {
+    const bsec_output_t &out = outputs.output[i];
+    if (out.sensor_id >= MAX_SENSOR_ID) continue;
+    int8_t slot = index.slot[out.sensor_id];
+    if (slot < 0) continue;
+    const BsecField &f = BSEC_FIELDS[slot];
+    vals.*f.signal = out.signal * f.scale;
+    if (f.accuracy) vals.*f.accuracy = out.accuracy;
+  }
+}
+
+void clearBsecFields(SensorValues &vals, BsecOutputMask mask) {
+  for (uint8_t i = 0; i < BSEC_FIELD_COUNT; ++i) {
+    const BsecField &f = BSEC_FIELDS[i];
+    if (mask & bsecMask(f.id)) continue;
+    vals.*f.signal = NAN;
+    if (f.accuracy) vals.*f.accuracy = 0;
+  }
+}
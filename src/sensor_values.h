@@ -0,0 +1,173 @@
+#pragma once
+// 一次测量周期的全部数据, 以及 BSEC 虚拟传感器 -> SensorValues 字段的编译期映射表。
+// 订阅列表和输出解析都从 BSEC_FIELDS 生成: 新增一个输出只需加一行, 不会出现订阅了却没读、或读了却没订阅。
+#include <Arduino.h>
+#include "bsec_backend.h"
+
+struct SensorValues {
+  float temperature{NAN};
+  float humidity{NAN};
+  float pressure_hPa{NAN};
+  float gas_kOhm{NAN};
+  float altitude_m{NAN};
+  float iaq{NAN};
+  uint8_t iaqAccuracy{0};
+  float staticIaq{NAN};
+  float co2eq{NAN};
+  float vocEq{NAN};
+  float compTemperature{NAN}; // 加热补偿后的温度
+  float compHumidity{NAN};    // 加热补偿后的湿度
+  float stabilization{NAN};   // BSEC 稳定状态: 1 = 上电后气体传感器已稳定
+  float runIn{NAN};           // BSEC 磨合状态: 1 = 传感器已完成磨合 (新传感器/长时间断电后需要)
+  uint32_t readUs{0};  // envSensor.run() + 输出解析的实测耗时
+  int64_t timestampMs{0}; // BSEC 输出时间戳
+  uint32_t periodMs{0};   // 产生该样本时的 BSEC 采样周期
+  uint8_t sensor{0};      // 来源传感器在 SensorArray 中的序号
+  // 简易 VOC 指数相关
+  float gasComp_kOhm{NAN};   // 温湿度补偿到 25°C/50%RH 的气体阻值 (gas_compensation.h), 简易 VOC 基线/指数基于它
+  float simpleVocIndex{NAN};
+  float gasBaseline_kOhm{NAN};
+  // 滑动窗口最小/最大值 (窗口长度见 ROLLING_FIELDS), 由 loop() 的数据管线填充
+  float gasMinWindow_kOhm{NAN};
+  float gasMaxWindow_kOhm{NAN};
+  float tempMinWindow{NAN};
+  float tempMaxWindow{NAN};
+  float humidityMinWindow{NAN};
+  float humidityMaxWindow{NAN};
+  float pressureMinWindow_hPa{NAN};
+  float pressureMaxWindow_hPa{NAN};
+};
+
+struct BsecField {
+  bsec_virtual_sensor_t id;
+  float SensorValues::*signal;
+  uint8_t SensorValues::*accuracy; // 不需要精度的输出为 nullptr
+  float scale;                     // signal 乘以该系数后写入字段
+};
+
+// 压力保持 BSEC 原始值, 单位在 publishSample() 中自适应 (Pa/hPa)
+constexpr BsecField BSEC_FIELDS[] = {
+  {BSEC_OUTPUT_RAW_TEMPERATURE, &SensorValues::temperature, nullptr, 1.0f},
+  {BSEC_OUTPUT_RAW_PRESSURE, &SensorValues::pressure_hPa, nullptr, 1.0f},
+  {BSEC_OUTPUT_RAW_HUMIDITY, &SensorValues::humidity, nullptr, 1.0f},
+  {BSEC_OUTPUT_RAW_GAS, &SensorValues::gas_kOhm, nullptr, 0.001f}, // Ohm -> kOhm
+  {BSEC_OUTPUT_IAQ, &SensorValues::iaq, &SensorValues::iaqAccuracy, 1.0f},
+  {BSEC_OUTPUT_STATIC_IAQ, &SensorValues::staticIaq, nullptr, 1.0f},
+  {BSEC_OUTPUT_CO2_EQUIVALENT, &SensorValues::co2eq, nullptr, 1.0f},
+  {BSEC_OUTPUT_BREATH_VOC_EQUIVALENT, &SensorValues::vocEq, nullptr, 1.0f},
+  {BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_TEMPERATURE, &SensorValues::compTemperature, nullptr, 1.0f},
+  {BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_HUMIDITY, &SensorValues::compHumidity, nullptr, 1.0f},
+  {BSEC_OUTPUT_STABILIZATION_STATUS, &SensorValues::stabilization, nullptr, 1.0f},
+  {BSEC_OUTPUT_RUN_IN_STATUS, &SensorValues::runIn, nullptr, 1.0f},
+};
+constexpr uint8_t BSEC_FIELD_COUNT = sizeof(BSEC_FIELDS) / sizeof(BSEC_FIELDS[0]);
+static_assert(BSEC_FIELD_COUNT <= BSEC_NUMBER_OUTPUTS, "BSEC_FIELDS 超出 BSEC 输出数量上限");
+
+// 维护滑动窗口最小/最大值的字段; 新增一个通道只需加一行 (并在 SensorValues 中加对应的两个字段)
+struct RollingField {
+  const char *name;                // 串口命令中的通道名
+  float SensorValues::*value;
+  float SensorValues::*min;
+  float SensorValues::*max;
+  uint32_t windowMs;               // 默认窗口长度, 可用 `window <通道> <秒>` 修改
+};
+
+constexpr RollingField ROLLING_FIELDS[] = {
+  {"gas", &SensorValues::gas_kOhm, &SensorValues::gasMinWindow_kOhm, &SensorValues::gasMaxWindow_kOhm, 5UL * 60UL * 1000UL},
+  {"temp", &SensorValues::compTemperature, &SensorValues::tempMinWindow, &SensorValues::tempMaxWindow, 60UL * 60UL * 1000UL},
+  {"hum", &SensorValues::compHumidity, &SensorValues::humidityMinWindow, &SensorValues::humidityMaxWindow, 60UL * 60UL * 1000UL},
+  {"pressure", &SensorValues::pressure_hPa, &SensorValues::pressureMinWindow_hPa, &SensorValues::pressureMaxWindow_hPa, 3UL * 60UL * 60UL * 1000UL},
+};
+constexpr uint8_t ROLLING_FIELD_COUNT = sizeof(ROLLING_FIELDS) / sizeof(ROLLING_FIELDS[0]);
+constexpr uint8_t ROLLING_GAS = 0; // 气体阻值在 ROLLING_FIELDS 中的下标 (简易 VOC 快照使用)
+static_assert(ROLLING_FIELDS[ROLLING_GAS].value == &SensorValues::gas_kOhm, "ROLLING_GAS 应指向气体阻值");
+
+// 变点检测 (change_detector.h) 的通道; k/h 为每个样本的偏离与报警阈值, 单位同通道
+// logScale: 对数通道取 100*ln(值), 偏离约等于相对变化的百分比, 阈值与阻值的绝对水平 (漂移/个体差异) 无关
+struct EventChannel {
+  const char *name;
+  float SensorValues::*value;
+  uint8_t SensorValues::*accuracy; // 非空时精度 >= 1 才检测 (BSEC 尚未校准的输出不可信)
+  bool compensated;                // 基于温湿度补偿值: 补偿模型学好前不检测, 否则 HVAC 启停会被当成事件
+  bool logScale;
+  int8_t direction;                // -1 = 下降为事件, +1 = 上升为事件
+  float k;
+  float h;
+  float tauMin;                    // 参考水平的时间常数 (分钟)
+};
+
+constexpr EventChannel EVENT_CHANNELS[] = {
+  {"gas", &SensorValues::gasComp_kOhm, nullptr, true, true, -1, 3.0f, 20.0f, 30.0f},
+  {"iaq", &SensorValues::iaq, &SensorValues::iaqAccuracy, false, false, +1, 60.0f, 120.0f, 30.0f},
+};
+constexpr uint8_t EVENT_CHANNEL_COUNT = sizeof(EVENT_CHANNELS) / sizeof(EVENT_CHANNELS[0]);
+
+// 多分辨率统计 (stats_rollup.h) 的通道; 未订阅/缺失的字段 (NAN) 不计入
+struct StatField {
+  const char *name;
+  float SensorValues::*value;
+};
+
+constexpr StatField STAT_FIELDS[] = {
+  {"temp", &SensorValues::compTemperature},
+  {"hum", &SensorValues::compHumidity},
+  {"pressure", &SensorValues::pressure_hPa},
+  {"gas", &SensorValues::gas_kOhm},
+  {"iaq", &SensorValues::iaq},
+  {"co2eq", &SensorValues::co2eq},
+  {"voc", &SensorValues::simpleVocIndex},
+};
+constexpr uint8_t STAT_FIELD_COUNT = sizeof(STAT_FIELDS) / sizeof(STAT_FIELDS[0]);
+constexpr uint8_t STAT_TEMP = 0, STAT_HUM = 1; // 串口显示的一小时均值使用
+static_assert(STAT_FIELDS[STAT_TEMP].value == &SensorValues::compTemperature && STAT_FIELDS[STAT_HUM].value == &SensorValues::compHumidity,
+              "STAT_TEMP/STAT_HUM 应指向补偿温湿度");
+
+// 压缩历史 (sample_history.h) 的通道: 测量值与 BSEC 输出; 可由它们重新算出的量 (海拔、滑动窗口、补偿阻值/基线) 不保存。
+// 只列有消费者订阅的输出 (原始温湿度、静态 IAQ 没有人订阅, 恒为 NAN, 不保存)
+// 数值先按 quantum 量化为整数 (对数通道量化 ln(值), 0.001 即 0.1%), 分辨率以传感器/算法本身的有效位数为准
+struct HistoryField {
+  const char *name;
+  float SensorValues::*value;
+  uint8_t SensorValues::*u8;       // 整数字段 (value 为 nullptr 时使用)
+  float quantum;
+  bool logScale;
+};
+
+constexpr HistoryField HISTORY_FIELDS[] = {
+  {"temp", &SensorValues::compTemperature, nullptr, 0.01f, false},
+  {"hum", &SensorValues::compHumidity, nullptr, 0.01f, false},
+  {"pressure", &SensorValues::pressure_hPa, nullptr, 0.01f, false},
+  {"gas", &SensorValues::gas_kOhm, nullptr, 0.001f, true},
+  {"iaq", &SensorValues::iaq, nullptr, 0.1f, false},
+  {"iaq_acc", nullptr, &SensorValues::iaqAccuracy, 1.0f, false},
+  {"co2eq", &SensorValues::co2eq, nullptr, 1.0f, false},
+  {"voceq", &SensorValues::vocEq, nullptr, 0.01f, false},
+  {"stab", &SensorValues::stabilization, nullptr, 1.0f, false},
+  {"run_in", &SensorValues::runIn, nullptr, 1.0f, false},
+  {"voc", &SensorValues::simpleVocIndex, nullptr, 0.1f, false},
+};
+constexpr uint8_t HISTORY_FIELD_COUNT = sizeof(HISTORY_FIELDS) / sizeof(HISTORY_FIELDS[0]);
+
+typedef uint32_t BsecOutputMask; // 第 id 位 = 虚拟传感器 id
+
+constexpr BsecOutputMask bsecMask() { return 0; }
+template <typename... Rest>
+constexpr BsecOutputMask bsecMask(bsec_virtual_sensor_t id, Rest... rest) {
+  return (1UL << id) | bsecMask(rest...);
+}
+
+// 映射表中属于 mask 的虚拟传感器, 用于 updateSubscription()
+struct BsecSubscription {
+  bsec_virtual_sensor_t ids[BSEC_FIELD_COUNT];
+  uint8_t count;
+  BsecOutputMask mask; // 实际包含的传感器 (mask 中没有映射字段的位被忽略)
+};
+BsecSubscription bsecSubscription(BsecOutputMask mask);
+
+// 产生该字段的 BSEC 输出 (按 BSEC_FIELDS 的 signal/accuracy 查找), 供消费者由字段表生成订阅;
+// 不由 BSEC 直接产生的字段 (简易 VOC 指数、补偿阻值等派生量) 返回 0
+BsecOutputMask bsecFieldMask(float SensorValues::*value, uint8_t SensorValues::*u8 = nullptr);
+// 单次遍历 BSEC 输出, 按映射表填充 vals (未出现在本次输出中的字段保持原值)
+void applyBsecOutputs(const bsecOutputs &outputs, SensorValues &vals);
+// 把不在 mask 中的映射字段置为 NAN (取消订阅后不再显示旧值)
+void clearBsecFields(SensorValues &vals, BsecOutputMask mask);
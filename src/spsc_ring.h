@@ -0,0 +1,44 @@
+#pragma once
+// 单生产者/单消费者无锁环形队列: 采集任务 (core 0) 写, loop() (core 1) 读。
+// N 必须是 2 的幂; 读写索引单调递增, 只有各自的一方修改, 以 acquire/release 保证元素可见性。
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+
+template <typename T, size_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+  // 生产者调用; 队列满时返回 false 并计入 dropped()
+  bool push(const T &item) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= N) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    slots_[head & (N - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 消费者调用; 队列空时返回 false
+  bool pop(T &item) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) return false;
+    item = slots_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  T slots_[N];
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+  std::atomic<uint32_t> dropped_{0};
+};
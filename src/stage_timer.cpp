@@ -0,0 +1,75 @@
+#include "stage_timer.h"
+
+StageTimers stageTimers;
+
+static const char *STAGE_NAMES[STAGE_COUNT] = {
+  "M5.update",
+  "envSensor.run",
+  "解析输出",
+  "updateDynamicUI",
+  "串口输出",
+  "saveState",
+  "flashLog.append",
+};
+
+// 格号: 高 5 位是最高有效位的位置, 低 2 位是其后两位 (小于 SUB_BUCKETS 的值直接落在前几格)
+static uint8_t bucketOf(uint32_t cycles) {
+  if (cycles < StageHistogram::SUB_BUCKETS) return (uint8_t)cycles;
+  uint8_t msb = 31 - __builtin_clz(cycles);
+  uint8_t sub = (cycles >> (msb - 2)) & 0x3;
+  uint32_t idx = (uint32_t)(msb - 1) * StageHistogram::SUB_BUCKETS + sub;
+  return idx < StageHistogram::BUCKETS ? (uint8_t)idx : StageHistogram::BUCKETS - 1;
+}
+
+static uint32_t bucketMid(uint8_t idx) {
+  if (idx < StageHistogram::SUB_BUCKETS) return idx;
+  uint8_t msb = idx / StageHistogram::SUB_BUCKETS + 1;
+  uint8_t sub = idx % StageHistogram::SUB_BUCKETS;
+  uint32_t lo = (1UL << msb) | ((uint32_t)sub << (msb - 2));
+  return lo + (1UL << (msb - 2)) / 2;
+}
+
+void StageHistogram::record(uint32_t cycles) {
+  ++count;
+  sumCycles += cycles;
+  if (cycles < minCycles) minCycles = cycles;
+  if (cycles > maxCycles) maxCycles = cycles;
+  ++buckets[bucketOf(cycles)];
+}
+
+uint32_t StageHistogram::percentile(float p) const {
+  if (count == 0) return 0;
+  uint32_t target = (uint32_t)ceilf(count * p);
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < BUCKETS; ++i) {
+    seen += buckets[i];
+    if (seen >= target) {
+      uint32_t mid = bucketMid(i);
+      if (mid > maxCycles) mid = maxCycles;
+      if (mid < minCycles) mid = minCycles;
+      return mid;
+    }
+  }
+  return maxCycles;
+}
+
+void StageTimers::print() const {
+  Serial.println("=== 阶段耗时 (us) ===");
+  Serial.printf("%-16s %8s %8s %8s %8s %8s\n", "阶段", "次数", "最小", "平均", "最大", "p99");
+  for (uint8_t i = 0; i < STAGE_COUNT; ++i) {
+    const StageHistogram &h = hist[i];
+    if (h.count == 0) {
+      Serial.printf("%-16s %8u %8s %8s %8s %8s\n", STAGE_NAMES[i], 0u, "-", "-", "-", "-");
+      continue;
+    }
+    Serial.printf("%-16s %8u %8u %8u %8u %8u\n", STAGE_NAMES[i], h.count, toUs(h.minCycles),
+                  toUs((uint32_t)(h.sumCycles / h.count)), toUs(h.maxCycles), toUs(h.percentile(0.99f)));
+  }
+  Serial.println("====================");
+}
+
+void StageTimers::reset(uint32_t stageMask) {
+  for (uint8_t i = 0; i < STAGE_COUNT; ++i) {
+    if (stageMask >> i & 1) hist[i] = StageHistogram();
+  }
+}
@@ -0,0 +1,49 @@
+#pragma once
+// loop() 各阶段的 CPU 周期计时 (Xtensa CCOUNT, 240 MHz 下 32 位约 17.9 s 回绕, 单阶段远小于此)。
+// 每个阶段维护 最小/平均/最大 与对数直方图 (每倍频 4 格), 由此估算 p99。
+#include <Arduino.h>
+
+enum Stage : uint8_t {
+  STAGE_M5_UPDATE,
+  STAGE_BSEC_RUN,
+  STAGE_PARSE_OUTPUTS,
+  STAGE_UI,
+  STAGE_SERIAL,
+  STAGE_SAVE_STATE,
+  STAGE_FLASH_LOG,
+  STAGE_COUNT
+};
+
+struct StageHistogram {
+  static const uint8_t SUB_BUCKETS = 4;
+  static const uint8_t BUCKETS = 32 * SUB_BUCKETS;
+
+  uint32_t count{0};
+  uint32_t minCycles{UINT32_MAX};
+  uint32_t maxCycles{0};
+  uint64_t sumCycles{0};
+  uint32_t buckets[BUCKETS]{};
+
+  void record(uint32_t cycles);
+  uint32_t percentile(float p) const; // 返回对应直方图格的中点 (周期数)
+};
+
+class StageTimers {
+public:
+  static uint32_t now() { return ESP.getCycleCount(); }
+  // 记录一次耗时并返回它 (周期数)
+  uint32_t end(Stage s, uint32_t startCycles) {
+    uint32_t c = now() - startCycles;
+    hist[s].record(c);
+    return c;
+  }
+  uint32_t toUs(uint32_t cycles) const { return cycles / ESP.getCpuFreqMHz(); }
+  void print() const;
+  // 清零 stageMask (第 s 位 = 阶段 s) 中的阶段; 每个阶段只由记录它的任务清零
+  void reset(uint32_t stageMask);
+
+private:
+  StageHistogram hist[STAGE_COUNT];
+};
+
+extern StageTimers stageTimers;
@@ -0,0 +1,124 @@
+#pragma once
+// 多分辨率流式统计: 按固定时长分桶 (1 分钟 / 1 小时 / 24 小时), 每个桶保存各通道的样本数、均值、
+// M2 (Welford 增量方差)、最小/最大值。样本到达时只更新当前桶, 每通道 O(1), 不保存原始样本。
+// 存储为定长环形缓冲的结构数组 (SoA): 每个统计量按 [通道][桶] 连续存放, 查询"最近一小时"只顺序读一个通道的几段连续内存。
+// 多个桶的合并用 Chan 等人的并行公式, 与逐样本计算的结果一致 (仅有浮点误差)。
+#include <math.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// 一个桶或若干桶合并后的统计量
+struct RunningStats {
+  uint32_t n = 0;
+  float mean = NAN;
+  float m2 = 0.0f;
+  float min = NAN;
+  float max = NAN;
+
+  float variance() const { return n > 1 ? m2 / (n - 1) : NAN; }
+  float stddev() const { return n > 1 ? sqrtf(m2 / (n - 1)) : NAN; }
+
+  void merge(uint32_t nb, float meanb, float m2b, float minb, float maxb) {
+    if (nb == 0) return;
+    if (n == 0) {
+      n = nb;
+      mean = meanb;
+      m2 = m2b;
+      min = minb;
+      max = maxb;
+      return;
+    }
+    uint32_t total = n + nb;
+    float delta = meanb - mean;
+    mean += delta * nb / total;
+    m2 += m2b + delta * delta * ((float)n * nb / total);
+    n = total;
+    if (minb < min) min = minb;
+    if (maxb > max) max = maxb;
+  }
+};
+
+template <uint8_t CHANNELS, uint16_t BUCKETS>
+class StatsRollup {
+  static_assert(CHANNELS >= 1 && BUCKETS >= 2, "StatsRollup size out of range");
+
+public:
+  // 修改桶时长会清空已有统计
+  void setResolution(uint32_t ms) {
+    resMs = ms ? ms : 1;
+    clear();
+  }
+  uint32_t resolution() const { return resMs; }
+  void clear() { used = 0; }
+  // 已保留的桶数 (含当前桶, 中间没有样本的桶也占一格)
+  uint16_t size() const { return used; }
+
+  // 一个样本的全部通道 (NAN 不计入)。时间戳需单调; 回退 (重新初始化、回放) 时从头开始
+  void push(int64_t tsMs, const float x[CHANNELS]) {
+    if (tsMs < 0) return;
+    int64_t b = tsMs / resMs;
+    if (used && b < newest) clear();
+    if (!used || b != newest) advance(b);
+    for (uint8_t c = 0; c < CHANNELS; ++c) {
+      float v = x[c];
+      if (isnan(v)) continue;
+      uint32_t k = ++count[c][head];
+      if (k == 1) {
+        mean[c][head] = lo[c][head] = hi[c][head] = v;
+        m2[c][head] = 0.0f;
+        continue;
+      }
+      float d = v - mean[c][head];
+      mean[c][head] += d / k;
+      m2[c][head] += d * (v - mean[c][head]);
+      if (v < lo[c][head]) lo[c][head] = v;
+      if (v > hi[c][head]) hi[c][head] = v;
+    }
+  }
+
+  // back = 0 为当前 (未结束) 桶, 1 为上一个, 依此类推; 超出保留范围时返回 false
+  bool bucket(uint8_t ch, uint16_t back, RunningStats &out, int64_t *startMs = nullptr) const {
+    out = RunningStats();
+    if (back >= used) return false;
+    uint16_t s = slot(back);
+    out.merge(count[ch][s], mean[ch][s], m2[ch][s], lo[ch][s], hi[ch][s]);
+    if (startMs) *startMs = (newest - back) * (int64_t)resMs;
+    return true;
+  }
+
+  // 最近 buckets 个桶 (含当前桶) 合并, 如 1 分钟桶取 60 个即"最近一小时"
+  RunningStats recent(uint8_t ch, uint16_t buckets) const {
+    RunningStats out;
+    if (buckets > used) buckets = used;
+    for (uint16_t back = 0; back < buckets; ++back) {
+      uint16_t s = slot(back);
+      out.merge(count[ch][s], mean[ch][s], m2[ch][s], lo[ch][s], hi[ch][s]);
+    }
+    return out;
+  }
+
+private:
+  uint16_t slot(uint16_t back) const { return (uint16_t)((head + BUCKETS - back) % BUCKETS); }
+
+  // 开始桶 b; 跳过的桶 (没有样本) 清零后保留, 最多清一整圈
+  void advance(int64_t b) {
+    int64_t steps = used ? b - newest : 1;
+    if (steps > BUCKETS) steps = BUCKETS;
+    for (int64_t i = 0; i < steps; ++i) {
+      head = (uint16_t)((head + 1) % BUCKETS);
+      for (uint8_t c = 0; c < CHANNELS; ++c) count[c][head] = 0;
+    }
+    used = (uint16_t)(used + steps > BUCKETS ? BUCKETS : used + steps);
+    newest = b;
+  }
+
+  uint32_t resMs = 60000;
+  int64_t newest = 0;   // 当前桶的序号 (时间戳 / 桶时长)
+  uint16_t head = 0;    // 当前桶在环中的位置
+  uint16_t used = 0;
+  uint32_t count[CHANNELS][BUCKETS];
+  float mean[CHANNELS][BUCKETS];
+  float m2[CHANNELS][BUCKETS];
+  float lo[CHANNELS][BUCKETS];
+  float hi[CHANNELS][BUCKETS];
+};
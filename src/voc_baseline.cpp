@@ -0,0 +1,50 @@
+#include "voc_baseline.h"
+
+static const float TAU_UP_MIN = 4.0f * 60.0f;     // 阻值高于基线: 4 小时
+static const float TAU_DOWN_MIN = 24.0f * 60.0f;  // 阻值低于基线: 1 天
+static const int64_t MAX_STEP_MS = 30LL * 60LL * 1000LL; // 样本间隔过长 (暂停/扫描) 时最多按 30 分钟计
+static const uint8_t BLOB_VERSION = 3;
+
+void VocBaseline::seed(float gas_kOhm) {
+  if (isnan(gas_kOhm) || gas_kOhm <= 0) return;
+  baseline = gas_kOhm;
+  trackedMs = 0;
+}
+
+void VocBaseline::update(int64_t tsMs, float gas_kOhm) {
+  if (isnan(gas_kOhm) || gas_kOhm <= 0) return;
+  int64_t dtMs = lastTsMs >= 0 && tsMs > lastTsMs ? tsMs - lastTsMs : 0;
+  lastTsMs = tsMs;
+  if (!established() || dtMs == 0) return;
+  if (dtMs > MAX_STEP_MS) dtMs = MAX_STEP_MS;
+  float dtMin = dtMs / 60000.0f;
+  float tau = gas_kOhm > baseline ? TAU_UP_MIN : TAU_DOWN_MIN;
+  baseline += (1.0f - expf(-dtMin / tau)) * (gas_kOhm - baseline);
+  trackedMs += dtMs;
+}
+
+float VocBaseline::index(float gas_kOhm) const {
+  if (!established() || isnan(gas_kOhm)) return NAN;
+  float index = (baseline - gas_kOhm) / baseline * 100.0f;
+  return index < 0 ? 0 : index; // 不允许负值
+}
+
+void VocBaseline::save(VocBaselineBlob &blob) const {
+  blob = {};
+  blob.version = BLOB_VERSION;
+  blob.baseline_kOhm = baseline;
+  blob.trackedHours = trackedHours();
+}
+
+bool VocBaseline::restore(const VocBaselineBlob &blob) {
+  if (blob.version != BLOB_VERSION || isnan(blob.baseline_kOhm) || blob.baseline_kOhm <= 0) return false;
+  baseline = blob.baseline_kOhm;
+  trackedMs = (int64_t)(blob.trackedHours * 3600000.0f);
+  return true;
+}
+
+void VocBaseline::clear() {
+  baseline = NAN;
+  lastTsMs = -1;
+  trackedMs = 0;
+}
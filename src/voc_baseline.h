@@ -0,0 +1,41 @@
+#pragma once
+// 简易 VOC 指数的自适应基线: 跟踪"洁净空气"下 (温湿度补偿后) 的气体阻值, 随传感器老化/季节漂移缓慢移动。
+// 非对称指数平均: 阻值高于基线时以 TAU_UP (4 小时) 跟上 (空气变干净), 低于基线时以 TAU_DOWN (1 天) 缓慢下降,
+// 几十分钟的 VOC 事件只把基线拉低不到 1%, 而持续数天的漂移会被完全跟上。结果相当于阻值的上分位数。
+// 每个样本 O(1), 每个传感器只有几个浮点数; 快照由 loop() 与 BSEC 状态一起写入 NVS, 重启后继续跟踪。
+#include <Arduino.h>
+#include "gas_compensation.h"
+
+// NVS 中保存的快照 (定长, 以版本号识别格式)。savedAtSec 与阻值范围由调用方填写, 用于重启时判断快照是否仍可直接使用
+struct VocBaselineBlob {
+  uint8_t version;
+  float baseline_kOhm;
+  float trackedHours;   // 基线已跟踪的累计时长
+  int64_t savedAtSec;   // 保存时的墙上时间 (Unix 秒), 0 = 当时没有有效时间
+  float gasMin_kOhm;    // 保存时气体阻值滑动窗口的最小/最大值
+  float gasMax_kOhm;
+  float compCoeffs[GAS_COMP_PARAMS]; // 温湿度补偿模型的系数
+};
+
+class VocBaseline {
+public:
+  bool established() const { return !isnan(baseline) && baseline > 0; }
+  float value() const { return baseline; }
+  float trackedHours() const { return trackedMs / 3600000.0f; }
+
+  // 以当前阻值作为初始基线 (没有可恢复的快照时)
+  void seed(float gas_kOhm);
+  // 每个样本调用 (未建立基线时只记录时间戳)
+  void update(int64_t tsMs, float gas_kOhm);
+  // 基线下降百分比, 阻值下降 => VOC 增加; 未建立基线时为 NAN
+  float index(float gas_kOhm) const;
+
+  void save(VocBaselineBlob &blob) const;
+  bool restore(const VocBaselineBlob &blob);
+  void clear();
+
+private:
+  float baseline = NAN;
+  int64_t lastTsMs = -1;
+  int64_t trackedMs = 0;
+};
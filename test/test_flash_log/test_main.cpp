@@ -0,0 +1,187 @@
+// FlashLog 的主机测试: 分区是 HostHal 的文件镜像 (esp_partition 替身), "重启" = 丢弃内存镜像后从文件重新载入。
+// 断电注入在写入/擦除的任意字节处切断, 检查恢复后: 读出的记录都完整, 按写入顺序连续, 所有已确认的记录都在,
+// 之后可以继续追加。运行: pio test -e native
+#include <unity.h>
+#include <HostHal.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "flash_log.h"
+
+static const char *LABEL = "samplelog";
+static const char *IMAGE = ".pio/test_flash_log.bin";
+static const char *BASE_IMAGE = ".pio/test_flash_log_base.bin";
+static const uint8_t TYPE = 7;
+static const uint16_t MAX_LEN = 48;
+
+void setUp() {}
+void tearDown() {}
+
+// 记录 id 的负载: 长度与内容都由 id 决定, 任何位错误都能发现
+static uint16_t payloadOf(uint32_t id, uint8_t *buf) {
+  uint16_t len = (uint16_t)(8 + id % (MAX_LEN - 7));
+  memcpy(buf, &id, sizeof(id));
+  for (uint16_t k = sizeof(id); k < len; ++k) buf[k] = (uint8_t)(id * 7 + k * 13);
+  return len;
+}
+
+static bool appendId(FlashLog &log, uint32_t id) {
+  uint8_t buf[MAX_LEN];
+  uint16_t len = payloadOf(id, buf);
+  return log.append(TYPE, buf, len);
+}
+
+// 读出全部记录, 校验内容并返回 id 序列
+static std::vector<uint32_t> readIds(const FlashLog &log) {
+  std::vector<uint32_t> ids;
+  FlashLogCursor c = log.read();
+  uint8_t type, buf[FlashLog::MAX_PAYLOAD], expect[MAX_LEN];
+  uint16_t len;
+  while (c.next(type, buf, len)) {
+    TEST_ASSERT_EQUAL_UINT8(TYPE, type);
+    uint32_t id;
+    TEST_ASSERT_TRUE(len >= sizeof(id));
+    memcpy(&id, buf, sizeof(id));
+    TEST_ASSERT_EQUAL_UINT16(payloadOf(id, expect), len);
+    TEST_ASSERT_EQUAL_MEMORY(expect, buf, len);
+    ids.push_back(id);
+  }
+  return ids;
+}
+
+static void freshImage(const char *path) {
+  remove(path);
+  host::flashReboot(path);
+}
+
+static bool copyFile(const char *from, const char *to) {
+  FILE *in = fopen(from, "rb"), *out = fopen(to, "wb");
+  bool ok = in && out;
+  char buf[65536];
+  size_t n;
+  while (ok && (n = fread(buf, 1, sizeof(buf), in)) > 0) ok = fwrite(buf, 1, n, out) == n;
+  if (in) fclose(in);
+  if (out) fclose(out);
+  return ok;
+}
+
+static uint32_t recordsPerBlockMin() {
+  return (FlashLog::BLOCK_BYTES - 16) / (MAX_LEN + 8);
+}
+
+void test_append_and_reboot() {
+  freshImage(IMAGE);
+  FlashLog log;
+  TEST_ASSERT_TRUE(log.begin(LABEL));
+  TEST_ASSERT_EQUAL_UINT32(0, log.headSeq());
+  TEST_ASSERT_EQUAL_UINT32(0, readIds(log).size());
+  for (uint32_t id = 0; id < 500; ++id) TEST_ASSERT_TRUE(appendId(log, id));
+
+  // 重启两次: 每次都另起新块, 已有记录不受影响
+  for (uint32_t boot = 1; boot <= 2; ++boot) {
+    host::flashReboot();
+    FlashLog again;
+    TEST_ASSERT_TRUE(again.begin(LABEL));
+    std::vector<uint32_t> ids = readIds(again);
+    TEST_ASSERT_EQUAL_UINT32(500 * boot, ids.size());
+    for (uint32_t k = 0; k < ids.size(); ++k) TEST_ASSERT_EQUAL_UINT32(k, ids[k]);
+    for (uint32_t id = 500 * boot; id < 500 * (boot + 1); ++id) TEST_ASSERT_TRUE(appendId(again, id));
+  }
+}
+
+void test_ring_wraps_and_levels_wear() {
+  freshImage(IMAGE);
+  FlashLog log;
+  TEST_ASSERT_TRUE(log.begin(LABEL));
+  uint32_t n = log.blockCount();
+  uint32_t id = 0;
+  while (log.headSeq() < n * 5 / 2) TEST_ASSERT_TRUE(appendId(log, id++));
+  uint32_t last = id - 1;
+
+  std::vector<uint32_t> ids = readIds(log);
+  TEST_ASSERT_TRUE(ids.size() >= (n - 1) * recordsPerBlockMin());
+  TEST_ASSERT_EQUAL_UINT32(last, ids.back());
+  for (uint32_t k = 1; k < ids.size(); ++k) TEST_ASSERT_EQUAL_UINT32(ids[k - 1] + 1, ids[k]);
+
+  FlashLogStats s = log.stats();
+  TEST_ASSERT_EQUAL_UINT32(n, s.valid);
+  TEST_ASSERT_EQUAL_UINT32(log.headSeq(), s.newestSeq);
+  TEST_ASSERT_EQUAL_UINT32(s.newestSeq - n + 1, s.oldestSeq);
+  TEST_ASSERT_TRUE(s.maxErase - s.minErase <= 1);
+  TEST_ASSERT_EQUAL_UINT32(3, s.maxErase);
+}
+
+// 断电后重启并校验; acked 为最后一条已确认的 id, 之后的 id 可能完整出现 (写完但未确认), 不会出现损坏的记录
+static uint32_t recoverAndCheck(uint32_t acked, uint32_t minRetained) {
+  host::flashReboot();
+  FlashLog log;
+  TEST_ASSERT_TRUE(log.begin(LABEL));
+  std::vector<uint32_t> ids = readIds(log);
+  TEST_ASSERT_TRUE(ids.size() >= minRetained);
+  for (uint32_t k = 1; k < ids.size(); ++k) TEST_ASSERT_EQUAL_UINT32(ids[k - 1] + 1, ids[k]);
+  TEST_ASSERT_TRUE(ids.back() == acked || ids.back() == acked + 1);
+  return ids.back();
+}
+
+void test_power_cut_recovery() {
+  // 基准镜像: 环已经绕过一圈, 断电也会落在擦除最旧块的过程中
+  freshImage(BASE_IMAGE);
+  uint32_t baseLast;
+  {
+    FlashLog log;
+    TEST_ASSERT_TRUE(log.begin(LABEL));
+    uint32_t id = 0;
+    while (log.headSeq() < log.blockCount() * 4 / 3) TEST_ASSERT_TRUE(appendId(log, id++));
+    baseLast = id - 1;
+  }
+  host::flashReboot(IMAGE);
+  uint32_t minRetained = 0;
+  {
+    FlashLog probe;
+    TEST_ASSERT_TRUE(copyFile(BASE_IMAGE, IMAGE));
+    TEST_ASSERT_TRUE(probe.begin(LABEL));
+    minRetained = (probe.blockCount() - 3) * recordsPerBlockMin();
+  }
+
+  // 切断点: 开头逐字节 (新块的擦除与块头), 之后按质数步长覆盖几个块的记录写入与换块
+  std::vector<int64_t> cuts;
+  for (int64_t b = 0; b < 48; ++b) cuts.push_back(b);
+  for (int64_t b = 48; b < 3 * 2 * (int64_t)FlashLog::BLOCK_BYTES; b += 211) cuts.push_back(b);
+  for (size_t k = 0; k < cuts.size(); ++k) {
+    TEST_ASSERT_TRUE(copyFile(BASE_IMAGE, IMAGE));
+    host::flashReboot(IMAGE);
+    FlashLog log;
+    TEST_ASSERT_TRUE(log.begin(LABEL));
+    host::flashPowerCutAfter(cuts[k]);
+    uint32_t id = baseLast + 1;
+    while (appendId(log, id)) ++id;
+    TEST_ASSERT_TRUE(host::flashPoweredOff());
+    uint32_t last = recoverAndCheck(id - 1, minRetained);
+
+    // 恢复后的第一次换块中再断一次电
+    FlashLog again;
+    host::flashReboot();
+    TEST_ASSERT_TRUE(again.begin(LABEL));
+    host::flashPowerCutAfter(cuts[cuts.size() - 1 - k] % (int64_t)(FlashLog::BLOCK_BYTES + 64));
+    id = last + 1;
+    while (appendId(again, id)) ++id;
+    last = recoverAndCheck(id - 1, minRetained);
+
+    // 之后正常追加, 重启后都在
+    FlashLog after;
+    host::flashReboot();
+    TEST_ASSERT_TRUE(after.begin(LABEL));
+    for (id = last + 1; id < last + 200; ++id) TEST_ASSERT_TRUE(appendId(after, id));
+    TEST_ASSERT_EQUAL_UINT32(id - 1, recoverAndCheck(id - 1, minRetained));
+  }
+  remove(BASE_IMAGE);
+  remove(IMAGE);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_append_and_reboot);
+  RUN_TEST(test_ring_wraps_and_levels_wear);
+  RUN_TEST(test_power_cut_recovery);
+  return UNITY_END();
+}
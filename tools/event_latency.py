@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""变点检测的检测延迟: 在录制文件上回放固件, 把 `event,...` 行与录制中的人工标记对比。
+
+    python3 tools/event_latency.py raw.bin                       # 回放现场录制 (标记由 `mark` 命令写入)
+    python3 tools/event_latency.py --synthetic 24 /tmp/raw.bin   # 先用主机合成数据录制 24 小时, 标记取自合成的 VOC 事件
+
+标记按顺序两两成对: 事件开始时执行一次 `mark`, 空气恢复后再执行一次。
+对每个通道统计: 检出的标记事件数, 检测延迟 (确认时刻 - 标记开始), 起点估计误差 (估计起点 - 标记开始),
+结束延迟 (结束事件 - 标记结束) 与误报 (不落在任何标记区间内的开始事件)。
+需要主机构建: `pio run -e native` (完整构建, 轻量构建不支持 --replay)。输出为 Markdown 表格。
+"""
+import argparse
+import os
+import statistics
+import struct
+import subprocess
+import sys
+
+PROGRAM = ".pio/build/native/program"
+# include/raw_record.h
+HEADER = struct.Struct("<IHHq")
+RECORD = struct.Struct("<BBBBIffff")
+MAGIC = 0x52454D42
+K_MARKER = 2
+# lib/HostHal/src/HostHal.cpp sampleEnvironment(): 每 3 小时一次, 第 1 小时开始, 爬升 1 分钟 + 保持 10 分钟 + 回落 5 分钟
+SIM_PERIOD_S = 3 * 3600
+SIM_START_S = 3600
+SIM_LENGTH_S = 16 * 60
+MATCH_SLACK_MS = 5 * 60 * 1000  # 标记结束后仍算作该事件的开始事件 (慢速采样时确认较晚)
+
+
+def read_markers(path):
+    with open(path, "rb") as f:
+        head = f.read(HEADER.size)
+        magic, version, size, t0 = HEADER.unpack(head)
+        if magic != MAGIC or size != RECORD.size:
+            sys.exit(f"{path}: 不是录制文件")
+        ts = t0
+        markers = []
+        while True:
+            buf = f.read(RECORD.size)
+            if len(buf) < RECORD.size:
+                break
+            rec = RECORD.unpack(buf)
+            ts += rec[4] * 1000
+            if rec[0] == K_MARKER:
+                markers.append(ts // 1000000)
+    if len(markers) % 2:
+        print(f"注意: 标记数为奇数 ({len(markers)}), 忽略最后一个", file=sys.stderr)
+        markers.pop()
+    return list(zip(markers[0::2], markers[1::2]))
+
+
+def record_synthetic(program, hours, path):
+    cmd = [program, "--hours", str(hours), "--quiet", "--record", path]
+    t = SIM_START_S
+    while t + SIM_LENGTH_S < hours * 3600:
+        cmd += ["--serial", f"mark@{t}", "--serial", f"mark@{t + SIM_LENGTH_S}"]
+        t += SIM_PERIOD_S
+    subprocess.run(cmd, check=True, capture_output=True)
+
+
+def replay_events(program, path):
+    out = subprocess.run([program, "--replay", path], check=True, capture_output=True, text=True, errors="replace")
+    events = []
+    for line in out.stdout.splitlines():
+        f = line.split(",")
+        if len(f) == 8 and f[0] == "event" and f[1] in ("start", "end"):
+            events.append({"type": f[1], "channel": f[3], "ts": int(f[4]), "onset": int(f[5]), "mag": float(f[6])})
+    return events
+
+
+def evaluate(intervals, events, channel):
+    starts = [e for e in events if e["channel"] == channel and e["type"] == "start"]
+    ends = [e for e in events if e["channel"] == channel and e["type"] == "end"]
+    latency, onset_err, end_latency = [], [], []
+    matched = set()
+    for begin, finish in intervals:
+        hit = next((e for e in starts if begin - MATCH_SLACK_MS <= e["ts"] <= finish + MATCH_SLACK_MS and id(e) not in matched), None)
+        if not hit:
+            continue
+        matched.add(id(hit))
+        latency.append((hit["ts"] - begin) / 1000)
+        onset_err.append((hit["onset"] - begin) / 1000)
+        end = next((e for e in ends if e["onset"] == hit["onset"]), None)
+        if end:
+            end_latency.append((end["ts"] - finish) / 1000)
+    false_pos = sum(1 for e in starts if id(e) not in matched)
+    return len(latency), latency, onset_err, end_latency, false_pos
+
+
+def fmt(values):
+    if not values:
+        return "-"
+    return f"{statistics.median(values):.0f} / {max(values, key=abs):.0f}"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("recording", help="录制文件 (--synthetic 时为输出路径)")
+    ap.add_argument("--synthetic", type=float, metavar="HOURS", help="先用主机合成数据录制 HOURS 小时")
+    ap.add_argument("--program", default=PROGRAM, help=f"主机构建的固件 (默认 {PROGRAM})")
+    args = ap.parse_args()
+
+    if not os.path.exists(args.program):
+        sys.exit(f"找不到 {args.program}, 先执行 pio run -e native")
+    if args.synthetic:
+        record_synthetic(args.program, args.synthetic, args.recording)
+    intervals = read_markers(args.recording)
+    if not intervals:
+        sys.exit(f"{args.recording}: 没有标记, 录制时用 `mark` 命令标出事件的开始与结束")
+    events = replay_events(args.program, args.recording)
+
+    print(f"标记事件 {len(intervals)} 个; 时间单位为秒, 列出中位数 / 绝对值最大者")
+    print()
+    print("| 通道 | 检出 | 检测延迟 | 起点误差 | 结束延迟 | 误报 |")
+    print("|------|-----:|---------:|---------:|---------:|-----:|")
+    for channel in sorted({e["channel"] for e in events} | {"gas", "iaq"}):
+        n, latency, onset_err, end_latency, false_pos = evaluate(intervals, events, channel)
+        print(f"| {channel} | {n}/{len(intervals)} | {fmt(latency)} | {fmt(onset_err)} | {fmt(end_latency)} | {false_pos} |")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""完整构建 (m5stack_s3, BSEC2) 与轻量构建 (m5stack_s3_raw, bme68x 直驱) 的体积/启动耗时对比。
+
+    python3 tools/variant_report.py                       # 只编译, 对比 RAM/Flash
+    python3 tools/variant_report.py --port /dev/ttyACM0   # 再依次烧录, 从串口读取启动耗时
+
+体积取自 `pio run` 的 RAM/Flash 汇总行; 启动耗时取自固件打印的
+"[启动] setup() 完成: N ms" 与 "[启动] 首个样本: N ms" (esp_timer, 从复位开始计时)。
+输出为 Markdown 表格, 可直接贴进 README 或 PR。
+"""
+import argparse
+import re
+import subprocess
+import sys
+import time
+
+ENVS = [("m5stack_s3", "BSEC2"), ("m5stack_s3_raw", "bme68x 直驱")]
+SIZE_RE = re.compile(r"^(RAM|Flash):.*\(used (\d+) bytes from (\d+) bytes\)", re.M)
+BOOT_RE = {
+    "setup": re.compile(r"\[启动\] setup\(\) 完成: (\d+) ms"),
+    "first": re.compile(r"\[启动\] 首个样本: (\d+) ms"),
+}
+
+
+def build(env):
+    out = subprocess.run(["pio", "run", "-e", env], capture_output=True, text=True)
+    if out.returncode != 0:
+        sys.exit(f"{env} 编译失败:\n{out.stdout[-2000:]}{out.stderr[-2000:]}")
+    sizes = {m.group(1): (int(m.group(2)), int(m.group(3))) for m in SIZE_RE.finditer(out.stdout)}
+    if len(sizes) != 2:
+        sys.exit(f"{env}: 没有找到 RAM/Flash 汇总行")
+    return sizes
+
+
+def boot_times(env, port, timeout_s):
+    import serial  # PlatformIO 自带 pyserial
+
+    subprocess.run(["pio", "run", "-e", env, "-t", "upload", "--upload-port", port], check=True,
+                   capture_output=True)
+    time.sleep(1.0)  # USB CDC 在复位后重新枚举
+    found = {}
+    with serial.Serial(port, 115200, timeout=0.5) as s:
+        # 再复位一次, 从干净的上电过程开始读
+        s.dtr = False
+        s.rts = True
+        time.sleep(0.1)
+        s.rts = False
+        deadline = time.time() + timeout_s
+        while time.time() < deadline and len(found) < len(BOOT_RE):
+            line = s.readline().decode("utf-8", "replace")
+            for key, rx in BOOT_RE.items():
+                m = rx.search(line)
+                if m:
+                    found[key] = int(m.group(1))
+    return found
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--port", help="CoreS3 串口; 不指定时只对比体积")
+    ap.add_argument("--timeout", type=float, default=30.0, help="等待启动输出的秒数")
+    args = ap.parse_args()
+
+    rows = []
+    for env, name in ENVS:
+        sizes = build(env)
+        boot = boot_times(env, args.port, args.timeout) if args.port else {}
+        rows.append((env, name, sizes, boot))
+
+    def cell(v):
+        return "-" if v is None else f"{v}"
+
+    print("| 构建 | 后端 | Flash (字节) | 静态 RAM (字节) | setup() 完成 (ms) | 首个样本 (ms) |")
+    print("|------|------|-------------:|----------------:|------------------:|--------------:|")
+    for env, name, sizes, boot in rows:
+        print(f"| `{env}` | {name} | {sizes['Flash'][0]} | {sizes['RAM'][0]} | "
+              f"{cell(boot.get('setup'))} | {cell(boot.get('first'))} |")
+    (_, _, full, fboot), (_, _, raw, rboot) = rows
+    print()
+    print(f"轻量构建节省: Flash {full['Flash'][0] - raw['Flash'][0]} 字节, 静态 RAM {full['RAM'][0] - raw['RAM'][0]} 字节")
+    if "first" in fboot and "first" in rboot:
+        print(f"首个样本提前 {fboot['first'] - rboot['first']} ms")
+
+
+if __name__ == "__main__":
+    main()